@@ -14,6 +14,7 @@
 #include <jni.h>
 #include <react/jni/JRuntimeExecutor.h>
 
+#include "torchlive/filesystem/FilesystemNamespace.h"
 #include "torchlive/torchlive.h"
 
 using namespace facebook;
@@ -37,8 +38,8 @@ class PyTorchCoreJSIModule : public jni::JavaClass<PyTorchCoreJSIModule> {
       jlong jsi,
       jni::alias_ref<
           react::JRuntimeExecutor::javaobject> /* jRuntimeExecutor */,
-      jni::alias_ref<react::CallInvokerHolder::javaobject>
-          jsCallInvokerHolder) {
+      jni::alias_ref<react::CallInvokerHolder::javaobject> jsCallInvokerHolder,
+      jni::alias_ref<jni::JString> cacheDirectory) {
     auto runtime = reinterpret_cast<jsi::Runtime*>(jsi);
     if (runtime) {
       // TODO(T113931827): we want RuntimeExecutor. However RN 0.64.3 on Android
@@ -62,6 +63,7 @@ class PyTorchCoreJSIModule : public jni::JavaClass<PyTorchCoreJSIModule> {
             }
           };
 
+      torchlive::filesystem::setCacheDirectory(cacheDirectory->toStdString());
       torchlive::install(*runtime, std::move(runtimeExecutor));
     }
   }
@@ -52,7 +52,10 @@ public class PyTorchCoreJSIModule extends ReactContextBaseJavaModule {
   }
 
   private native void nativeInstall(
-      long jsi, RuntimeExecutor runtimeExecutor, CallInvokerHolderImpl jsCallInvokerHolder);
+      long jsi,
+      RuntimeExecutor runtimeExecutor,
+      CallInvokerHolderImpl jsCallInvokerHolder,
+      String cacheDirectory);
 
   public void installLib(JavaScriptContextHolder reactContext) {
 
@@ -62,7 +65,9 @@ public class PyTorchCoreJSIModule extends ReactContextBaseJavaModule {
       CallInvokerHolderImpl jsCallInvokerHolder =
           (CallInvokerHolderImpl)
               getReactApplicationContext().getCatalystInstance().getJSCallInvokerHolder();
-      this.nativeInstall(reactContext.get(), runtimeExecutor, jsCallInvokerHolder);
+      String cacheDirectory = getReactApplicationContext().getCacheDir().getAbsolutePath();
+      this.nativeInstall(
+          reactContext.get(), runtimeExecutor, jsCallInvokerHolder, cacheDirectory);
     } else {
       Log.e(TAG, "JSI Runtime is not available in debug mode");
     }
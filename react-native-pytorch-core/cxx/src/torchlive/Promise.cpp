@@ -5,6 +5,9 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <utility>
 
 #include "Promise.h"
@@ -27,28 +30,114 @@ void Promise::reject(const std::string& message) {
   reject_.call(runtime_, error);
 }
 
+void Promise::reject(const std::string& message, const std::string& name) {
+  jsi::Object error(runtime_);
+  error.setProperty(
+      runtime_, "message", jsi::String::createFromUtf8(runtime_, message));
+  error.setProperty(
+      runtime_, "name", jsi::String::createFromUtf8(runtime_, name));
+  reject_.call(runtime_, error);
+}
+
+namespace {
+
+// Caches the global Promise constructor and an executor function for a
+// runtime. The Promise constructor calls the executor synchronously, which
+// stores the resolve and reject functions in the cache for createDeferred to
+// pick up. The cache is a host object that is kept alive by a global property,
+// so the cached functions are released with the runtime. The property is
+// neither enumerable, writable, nor configurable, so JavaScript can't release
+// the cache while the registry still points to it.
+class PromiseCache : public jsi::HostObject {
+ public:
+  explicit PromiseCache(jsi::Runtime& rt)
+      : promiseConstructor_(rt.global().getPropertyAsFunction(rt, "Promise")),
+        executor_(createExecutor(rt)) {}
+
+  Deferred createDeferred(jsi::Runtime& rt) {
+    auto promise = promiseConstructor_.callAsConstructor(rt, executor_);
+    auto resolver = std::make_shared<Promise>(
+        rt,
+        std::move(*captured_->resolve).getObject(rt).getFunction(rt),
+        std::move(*captured_->reject).getObject(rt).getFunction(rt));
+    captured_->resolve.reset();
+    captured_->reject.reset();
+    return {std::move(promise), std::move(resolver)};
+  }
+
+ private:
+  struct Captured {
+    std::unique_ptr<jsi::Value> resolve;
+    std::unique_ptr<jsi::Value> reject;
+  };
+
+  jsi::Function createExecutor(jsi::Runtime& rt) {
+    auto captured = captured_;
+    return jsi::Function::createFromHostFunction(
+        rt,
+        jsi::PropNameID::forAscii(rt, "fn"),
+        2,
+        [captured](
+            jsi::Runtime& rt,
+            const jsi::Value& thisValue,
+            const jsi::Value* args,
+            size_t count) {
+          captured->resolve = std::make_unique<jsi::Value>(rt, args[0]);
+          captured->reject = std::make_unique<jsi::Value>(rt, args[1]);
+          return jsi::Value::undefined();
+        });
+  }
+
+  std::shared_ptr<Captured> captured_ = std::make_shared<Captured>();
+  jsi::Function promiseConstructor_;
+  jsi::Function executor_;
+};
+
+std::shared_ptr<PromiseCache> getPromiseCache(jsi::Runtime& rt) {
+  // The cache is only accessed on the JavaScript thread of its runtime, but
+  // the registry is shared by all runtimes.
+  static std::mutex mutex;
+  static std::unordered_map<jsi::Runtime*, std::weak_ptr<PromiseCache>>
+      registry;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto cache = registry[&rt].lock();
+  if (cache == nullptr) {
+    cache = std::make_shared<PromiseCache>(rt);
+    jsi::Object descriptor(rt);
+    descriptor.setProperty(
+        rt, "value", jsi::Object::createFromHostObject(rt, cache));
+    rt.global()
+        .getPropertyAsObject(rt, "Object")
+        .getPropertyAsFunction(rt, "defineProperty")
+        .call(
+            rt,
+            rt.global(),
+            "__torchlivePromiseCache__",
+            std::move(descriptor));
+    registry[&rt] = cache;
+  }
+  return cache;
+}
+
+} // namespace
+
+Deferred createDeferred(jsi::Runtime& rt) {
+  return getPromiseCache(rt)->createDeferred(rt);
+}
+
 jsi::Value createPromiseAsJSIValue(
     jsi::Runtime& rt,
     const PromiseSetupFunctionType func) {
-  jsi::Function JSPromise = rt.global().getPropertyAsFunction(rt, "Promise");
-  jsi::Function fn = jsi::Function::createFromHostFunction(
-      rt,
-      jsi::PropNameID::forAscii(rt, "fn"),
-      2,
-      [func](
-          jsi::Runtime& rt2,
-          const jsi::Value& thisVal,
-          const jsi::Value* args,
-          size_t count) {
-        jsi::Function resolve = args[0].getObject(rt2).getFunction(rt2);
-        jsi::Function reject = args[1].getObject(rt2).getFunction(rt2);
-        auto wrapper = std::make_shared<Promise>(
-            rt2, std::move(resolve), std::move(reject));
-        func(rt2, wrapper);
-        return jsi::Value::undefined();
-      });
-
-  return JSPromise.callAsConstructor(rt, fn);
+  auto deferred = createDeferred(rt);
+  try {
+    func(rt, deferred.resolver);
+  } catch (const jsi::JSError& e) {
+    deferred.resolver->reject_.call(rt, e.value());
+  } catch (const std::exception& e) {
+    deferred.resolver->reject(e.what());
+  }
+  return std::move(deferred.promise);
 }
 
 } // namespace torchlive
@@ -27,14 +27,30 @@ struct Promise {
 
   void resolve(const facebook::jsi::Value& result);
   void reject(const std::string& error);
+  // Rejects with an error that has the given name, e.g., "AbortError".
+  void reject(const std::string& error, const std::string& name);
 
   facebook::jsi::Runtime& runtime_;
   facebook::jsi::Function resolve_;
   facebook::jsi::Function reject_;
 };
 
+// A JavaScript Promise together with the Promise helper to settle it.
+struct Deferred {
+  facebook::jsi::Value promise;
+  std::shared_ptr<Promise> resolver;
+};
+
+// Creates a pending Promise. The Promise constructor and the executor function
+// passed to it are created once per runtime, so this doesn't allocate a host
+// function per call.
+Deferred createDeferred(facebook::jsi::Runtime& rt);
+
 using PromiseSetupFunctionType =
     std::function<void(facebook::jsi::Runtime& rt, std::shared_ptr<Promise>)>;
+
+// Creates a Promise and calls func with the Promise helper to settle it. Like
+// in a Promise executor, an exception thrown by func rejects the Promise.
 facebook::jsi::Value createPromiseAsJSIValue(
     facebook::jsi::Runtime& rt,
     const PromiseSetupFunctionType func);
@@ -7,15 +7,128 @@
 
 #include "ThreadPool.h"
 
+#include <algorithm>
+
 namespace torchlive {
 
-ThreadPool::ThreadPool(std::size_t pool_size) : c10::ThreadPool(pool_size) {
+namespace {
+
+constexpr std::size_t kInteractive =
+    static_cast<std::size_t>(ThreadPool::Priority::kInteractive);
+constexpr std::size_t kBackground =
+    static_cast<std::size_t>(ThreadPool::Priority::kBackground);
+
+thread_local c10::optional<ThreadPool::Priority> currentPriority;
+
+} // namespace
+
+constexpr std::size_t ThreadPool::kMaxInteractiveStreak;
+constexpr std::size_t ThreadPool::kMaxThreads;
+
+ThreadPool::PriorityScope::PriorityScope(Priority priority)
+    : previous_(currentPriority) {
+  currentPriority = priority;
+}
+
+ThreadPool::PriorityScope::~PriorityScope() {
+  currentPriority = previous_;
+}
+
+ThreadPool::ThreadPool(std::size_t pool_size)
+    : c10::ThreadPool(pool_size),
+      maxBackgroundRunning_(std::max<std::size_t>(1, pool_size - 1)) {
   c10::setThreadName("TorchliveThread");
 }
 
 ThreadPool* ThreadPool::pool() {
-  static ThreadPool threadPool(c10::ThreadPool::defaultNumThreads());
+  // At least two threads, so background work leaves a thread for interactive
+  // work.
+  static ThreadPool threadPool(std::max<std::size_t>(
+      2,
+      std::min<std::size_t>(
+          c10::ThreadPool::defaultNumThreads(), kMaxThreads)));
   return &threadPool;
 }
 
+c10::optional<ThreadPool::Priority> ThreadPool::scopedPriority() {
+  return currentPriority;
+}
+
+void ThreadPool::run(std::function<void()> func) {
+  run(std::move(func), Priority::kInteractive);
+}
+
+void ThreadPool::run(std::function<void()> func, Priority priority) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lanes_[static_cast<std::size_t>(priority)].push_back(std::move(func));
+  }
+  c10::ThreadPool::run([this]() { runNext(); });
+}
+
+ThreadPool::Stats ThreadPool::stats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return {
+      {lanes_[kInteractive].size(),
+       running_[kInteractive],
+       completed_[kInteractive]},
+      {lanes_[kBackground].size(),
+       running_[kBackground],
+       completed_[kBackground]}};
+}
+
+bool ThreadPool::nextLane(std::size_t* lane) {
+  bool hasInteractive = !lanes_[kInteractive].empty();
+  bool canRunBackground = !lanes_[kBackground].empty() &&
+      running_[kBackground] < maxBackgroundRunning_;
+  if (hasInteractive &&
+      (!canRunBackground || interactiveStreak_ < kMaxInteractiveStreak)) {
+    interactiveStreak_++;
+    *lane = kInteractive;
+    return true;
+  }
+  if (canRunBackground) {
+    interactiveStreak_ = 0;
+    *lane = kBackground;
+    return true;
+  }
+  return false;
+}
+
+void ThreadPool::runNext() {
+  std::function<void()> func;
+  std::size_t lane;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!nextLane(&lane)) {
+      deferred_++;
+      return;
+    }
+    func = std::move(lanes_[lane].front());
+    lanes_[lane].pop_front();
+    running_[lane]++;
+  }
+
+  // Tasks are expected to handle their errors (see AsyncTask), but the
+  // bookkeeping below must happen regardless.
+  try {
+    func();
+  } catch (...) {
+  }
+
+  bool reschedule = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_[lane]--;
+    completed_[lane]++;
+    if (lane == kBackground && deferred_ > 0) {
+      deferred_--;
+      reschedule = true;
+    }
+  }
+  if (reschedule) {
+    c10::ThreadPool::run([this]() { runNext(); });
+  }
+}
+
 } // namespace torchlive
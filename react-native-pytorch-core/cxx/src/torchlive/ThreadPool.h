@@ -8,17 +8,99 @@
 #pragma once
 
 #include <c10/core/thread_pool.h>
+#include <c10/util/Optional.h>
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
 
 namespace torchlive {
 
 // A thread pool to do work off of the main JavaScript thread.
+//
+// Work is queued in one of two lanes. Interactive work (e.g., a per-frame
+// forward call) takes precedence over background work (e.g., loading a
+// model), but background work still runs at least once for every
+// kMaxInteractiveStreak interactive tasks, so neither lane starves. Background
+// work also leaves one thread of the pool free for interactive work, unless
+// the pool has a single thread.
 class ThreadPool : public c10::ThreadPool {
  public:
+  enum class Priority { kInteractive = 0, kBackground = 1 };
+
+  struct LaneStats {
+    // Tasks waiting for a thread.
+    std::size_t queued;
+    // Tasks currently running.
+    std::size_t running;
+    // Tasks finished since the pool was created.
+    std::uint64_t completed;
+  };
+
+  struct Stats {
+    LaneStats interactive;
+    LaneStats background;
+  };
+
+  // Sets the priority of the work that the current thread schedules while the
+  // scope is alive. Scopes can be nested.
+  class PriorityScope {
+   public:
+    explicit PriorityScope(Priority priority);
+    ~PriorityScope();
+
+    PriorityScope(const PriorityScope&) = delete;
+    PriorityScope& operator=(const PriorityScope&) = delete;
+
+   private:
+    c10::optional<Priority> previous_;
+  };
+
+  // Maximum number of interactive tasks to start in a row while background
+  // tasks are waiting.
+  static constexpr std::size_t kMaxInteractiveStreak = 4;
+
+  // Maximum number of threads of the pool. Model methods split their
+  // operators across the intra-op threads (see
+  // torch/jit/mobile/IntraOpThreads.h), which already use the cores, so a
+  // thread per core here would only oversubscribe them.
+  static constexpr std::size_t kMaxThreads = 4;
+
   // Singleton instance.
   static ThreadPool* pool();
 
+  // Returns the priority of the innermost PriorityScope of the current thread.
+  static c10::optional<Priority> scopedPriority();
+
+  // Runs func as interactive work.
+  void run(std::function<void()> func) override;
+
+  void run(std::function<void()> func, Priority priority);
+
+  Stats stats();
+
  private:
   explicit ThreadPool(std::size_t pool_size);
+
+  // Runs the next task. One call is scheduled on the underlying pool per
+  // queued task.
+  void runNext();
+
+  // Picks the lane of the next task, or returns false if no task can be
+  // started. Must be called with mutex_ held.
+  bool nextLane(std::size_t* lane);
+
+  std::mutex mutex_;
+  std::array<std::deque<std::function<void()>>, 2> lanes_;
+  std::array<std::size_t, 2> running_ = {{0, 0}};
+  std::array<std::uint64_t, 2> completed_ = {{0, 0}};
+  std::size_t maxBackgroundRunning_;
+  std::size_t interactiveStreak_ = 0;
+  // Number of runNext calls that found only background work which couldn't be
+  // started. They are rescheduled when a background task finishes.
+  std::size_t deferred_ = 0;
 };
 
 } // namespace torchlive
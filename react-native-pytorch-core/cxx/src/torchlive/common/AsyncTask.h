@@ -10,10 +10,13 @@
 #include <jsi/jsi.h>
 
 #include <functional>
+#include <memory>
+#include <string>
 
 #include "../Promise.h"
 #include "../ThreadPool.h"
 #include "../torchlive.h"
+#include "CancellationToken.h"
 
 namespace torchlive {
 namespace common {
@@ -24,6 +27,16 @@ namespace common {
 // setupFunc and resolveFunc are passed a jsi::Runtime reference and run on
 // React Native's JavaScript thread, but workFunc runs on a separate thread and
 // can not safely access jsi::Runtime.
+//
+// The work is scheduled with the given priority, unless the JavaScript call
+// happens within a ThreadPool::PriorityScope (e.g., experimental.withPriority).
+// Likewise, if the call happens within a CancellationToken::Scope and the
+// token is cancelled before the work starts, the work is dropped and the
+// Promise is rejected with an error named kCancellationErrorName.
+//
+// The work is posted to the ThreadPool, unless a schedule function is given,
+// which is called with the setup result and posts the work itself, e.g., to
+// wait for a resource without holding a thread of the pool.
 template <class TSetupResultType, class TWorkResultType>
 class AsyncTask {
  public:
@@ -45,30 +58,50 @@ class AsyncTask {
       RuntimeExecutor runtimeExecutor,
       WorkResultType&& inputs)>;
 
+  using ScheduleFunctionType = std::function<void(
+      const SetupResultType& setupResult,
+      std::function<void()> work,
+      ThreadPool::Priority priority)>;
+
   AsyncTask(
       SetupFunctionType setupFunc,
       WorkFunctionType workFunc,
-      ResolveFunctionType resolveFunc)
-      : setupFunc_(setupFunc), workFunc_(workFunc), resolveFunc_(resolveFunc) {}
+      ResolveFunctionType resolveFunc,
+      ThreadPool::Priority priority = ThreadPool::Priority::kInteractive,
+      ScheduleFunctionType scheduleFunc = nullptr)
+      : setupFunc_(setupFunc),
+        workFunc_(workFunc),
+        resolveFunc_(resolveFunc),
+        priority_(priority),
+        scheduleFunc_(scheduleFunc) {}
 
   facebook::jsi::HostFunctionType syncFunc(RuntimeExecutor runtimeExecutor);
 
   facebook::jsi::HostFunctionType asyncPromiseFunc(
       RuntimeExecutor runtimeExecutor) {
     return createPromiseFunction(
-        runtimeExecutor, setupFunc_, workFunc_, resolveFunc_);
+        runtimeExecutor,
+        setupFunc_,
+        workFunc_,
+        resolveFunc_,
+        priority_,
+        scheduleFunc_);
   }
 
   static facebook::jsi::HostFunctionType createPromiseFunction(
       RuntimeExecutor runtimeExecutor,
       SetupFunctionType setupFunc,
       WorkFunctionType workFunc,
-      ResolveFunctionType resolveFunc);
+      ResolveFunctionType resolveFunc,
+      ThreadPool::Priority priority = ThreadPool::Priority::kInteractive,
+      ScheduleFunctionType scheduleFunc = nullptr);
 
  private:
   SetupFunctionType setupFunc_;
   WorkFunctionType workFunc_;
   ResolveFunctionType resolveFunc_;
+  ThreadPool::Priority priority_;
+  ScheduleFunctionType scheduleFunc_;
 };
 
 template <class TSetupResultType, class TWorkResultType>
@@ -91,19 +124,28 @@ AsyncTask<TSetupResultType, TWorkResultType>::createPromiseFunction(
     RuntimeExecutor runtimeExecutor,
     SetupFunctionType setupFunc,
     WorkFunctionType workFunc,
-    ResolveFunctionType resolveFunc) {
+    ResolveFunctionType resolveFunc,
+    ThreadPool::Priority priority,
+    ScheduleFunctionType scheduleFunc) {
   return [=](facebook::jsi::Runtime& runtime,
              const facebook::jsi::Value& thisValue,
              const facebook::jsi::Value* arguments,
              size_t count) {
     SetupResultType setupResult;
     std::shared_ptr<Promise> promise;
+    auto token = CancellationToken::current();
     // Perform setupFunc within the Promise constructor so errors are captured
     // like they would be in an "async" JavaScript function.
     auto promiseValue = createPromiseAsJSIValue(
         runtime,
         [&](facebook::jsi::Runtime& promiseRuntime,
             std::shared_ptr<Promise> p) {
+          if (token != nullptr) {
+            if (auto reason = token->cancellationReason()) {
+              p->reject(*reason, kCancellationErrorName);
+              return;
+            }
+          }
           setupResult = setupFunc(promiseRuntime, thisValue, arguments, count);
           promise = std::move(p);
         });
@@ -114,18 +156,32 @@ AsyncTask<TSetupResultType, TWorkResultType>::createPromiseFunction(
       return promiseValue;
     }
 
-    // Start work on a separate thread.
-    auto threadFunc = [=, setupResult = std::move(setupResult)]() mutable {
+    // Start work on a separate thread. The setup result is shared with the
+    // schedule function, which only reads it before the work starts.
+    auto sharedSetupResult =
+        std::make_shared<SetupResultType>(std::move(setupResult));
+    auto threadFunc = [=]() {
+      if (token != nullptr) {
+        if (auto reason = token->cancellationReason()) {
+          runtimeExecutor([=, m = *reason](facebook::jsi::Runtime&) {
+            promise->reject(m, kCancellationErrorName);
+          });
+          return;
+        }
+      }
+
       WorkResultType workResult;
       bool error = false;
 
       try {
-        workResult = workFunc(std::move(setupResult));
+        workResult = workFunc(std::move(*sharedSetupResult));
       } catch (std::exception& e) {
         error = true;
         // Report the error on the JavaScript thread.
         runtimeExecutor(
-            [=, m = e.what()](facebook::jsi::Runtime&) { promise->reject(m); });
+            [=, m = std::string(e.what())](facebook::jsi::Runtime&) {
+              promise->reject(m);
+            });
       }
 
       if (!error) {
@@ -143,7 +199,12 @@ AsyncTask<TSetupResultType, TWorkResultType>::createPromiseFunction(
       }
     };
 
-    torchlive::ThreadPool::pool()->run(threadFunc);
+    auto threadPriority = ThreadPool::scopedPriority().value_or(priority);
+    if (scheduleFunc != nullptr) {
+      scheduleFunc(*sharedSetupResult, threadFunc, threadPriority);
+    } else {
+      torchlive::ThreadPool::pool()->run(threadFunc, threadPriority);
+    }
 
     return promiseValue;
   };
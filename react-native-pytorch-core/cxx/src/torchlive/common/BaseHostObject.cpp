@@ -7,6 +7,8 @@
 
 #include "BaseHostObject.h"
 
+#include <iterator>
+#include <mutex>
 #include <vector>
 
 namespace torchlive {
@@ -14,25 +16,159 @@ namespace common {
 
 using namespace facebook;
 
+// Holds the interned names and the jsi::Function objects for a list of shared
+// methods in a single runtime. Functions are created on first access, so
+// methods that are never called from JavaScript are never allocated.
+class BaseHostObject::MethodTable {
+ public:
+  MethodTable(
+      jsi::Runtime& rt,
+      const SharedMethods& methods,
+      const SharedProperties& properties)
+      : methods_(methods), properties_(properties), functions_(methods.size()) {
+    methodNames_.reserve(methods_.size());
+    for (const auto& method : methods_) {
+      methodNames_.push_back(jsi::PropNameID::forUtf8(rt, method.name));
+    }
+    propertyNames_.reserve(properties_.size());
+    for (const auto& property : properties_) {
+      propertyNames_.push_back(jsi::PropNameID::forUtf8(rt, property));
+    }
+  }
+
+  // Returns the method function, or undefined if there is no method with the
+  // given name.
+  jsi::Value get(jsi::Runtime& rt, const jsi::PropNameID& name) {
+    for (size_t i = 0; i < methodNames_.size(); i++) {
+      if (jsi::PropNameID::compare(rt, methodNames_[i], name)) {
+        auto& function = functions_[i];
+        if (function.isUndefined()) {
+          const auto& method = methods_[i];
+          function = jsi::Function::createFromHostFunction(
+              rt, methodNames_[i], method.paramCount, method.func);
+        }
+        return jsi::Value(rt, function);
+      }
+    }
+    return jsi::Value::undefined();
+  }
+
+  const std::string* findProperty(
+      jsi::Runtime& rt,
+      const jsi::PropNameID& name) const {
+    for (size_t i = 0; i < propertyNames_.size(); i++) {
+      if (jsi::PropNameID::compare(rt, propertyNames_[i], name)) {
+        return &properties_[i];
+      }
+    }
+    return nullptr;
+  }
+
+  const SharedMethods& methods() const noexcept {
+    return methods_;
+  }
+
+ private:
+  const SharedMethods& methods_;
+  const SharedProperties properties_;
+  std::vector<jsi::PropNameID> methodNames_;
+  std::vector<jsi::PropNameID> propertyNames_;
+  std::vector<jsi::Value> functions_;
+};
+
 BaseHostObject::BaseHostObject(jsi::Runtime& rt) {}
 
-BaseHostObject::~BaseHostObject() {}
+BaseHostObject::~BaseHostObject() {
+  releaseExternalMemory();
+}
+
+ExternalMemory BaseHostObject::getExternalMemory() const {
+  return {nullptr, 0};
+}
+
+void BaseHostObject::reportExternalMemory(
+    jsi::Runtime& rt,
+    const jsi::Object& object) {
+  releaseExternalMemory();
+  externalMemory_ =
+      common::reportExternalMemory(rt, object, getExternalMemory());
+}
+
+void BaseHostObject::releaseExternalMemory() {
+  common::releaseExternalMemory(externalMemory_);
+  externalMemory_ = {nullptr, 0};
+}
 
 jsi::Value BaseHostObject::get(jsi::Runtime& rt, const jsi::PropNameID& name) {
+  auto method = getSharedMethod(rt, name);
+  if (!method.isUndefined() || propertyMap_.empty()) {
+    return method;
+  }
   auto it = propertyMap_.find(name.utf8(rt));
   return it != propertyMap_.end() ? jsi::Value(rt, it->second)
                                   : jsi::Value::undefined();
 }
 
+jsi::Value BaseHostObject::get(
+    jsi::Runtime& rt,
+    const jsi::PropNameID& name,
+    const std::string& utf8Name) {
+  auto method = getSharedMethod(rt, name);
+  if (!method.isUndefined()) {
+    return method;
+  }
+  auto it = propertyMap_.find(utf8Name);
+  return it != propertyMap_.end() ? jsi::Value(rt, it->second)
+                                  : jsi::Value::undefined();
+}
+
 std::vector<jsi::PropNameID> BaseHostObject::getPropertyNames(
     jsi::Runtime& rt) {
   std::vector<jsi::PropNameID> result;
   for (const auto& it : propertyMap_) {
     result.push_back(jsi::PropNameID::forUtf8(rt, it.first));
   }
+  if (methodTable_ != nullptr) {
+    for (const auto& method : methodTable_->methods()) {
+      result.push_back(jsi::PropNameID::forUtf8(rt, method.name));
+    }
+  }
   return result;
 }
 
+const std::string* BaseHostObject::findSharedProperty(
+    jsi::Runtime& rt,
+    const jsi::PropNameID& name) const {
+  return methodTable_ != nullptr ? methodTable_->findProperty(rt, name)
+                                 : nullptr;
+}
+
+jsi::Value BaseHostObject::getSharedMethod(
+    jsi::Runtime& rt,
+    const jsi::PropNameID& name) {
+  return methodTable_ != nullptr ? methodTable_->get(rt, name)
+                                 : jsi::Value::undefined();
+}
+
+bool BaseHostObject::parseIndex(
+    const std::string& name,
+    int64_t* index) noexcept {
+  // Limit the digits to avoid overflow. Larger indices are out of bounds for
+  // any tensor that fits into memory on a mobile device.
+  if (name.empty() || name.size() > 18) {
+    return false;
+  }
+  int64_t value = 0;
+  for (char c : name) {
+    if (c < '0' || c > '9') {
+      return false;
+    }
+    value = value * 10 + (c - '0');
+  }
+  *index = value;
+  return true;
+}
+
 void BaseHostObject::setProperty(
     jsi::Runtime& rt,
     const std::string& name,
@@ -52,5 +188,39 @@ void BaseHostObject::setPropertyHostFunction(
           rt, jsi::PropNameID::forUtf8(rt, name), paramCount, std::move(func)));
 }
 
+void BaseHostObject::setSharedMethods(
+    jsi::Runtime& rt,
+    const SharedMethods& methods,
+    const SharedProperties& properties) {
+  // The method tables are owned by the host objects using them, so a table is
+  // released with the last host object of its runtime. The registry only keeps
+  // weak references to find the table of a runtime again.
+  using RuntimeMethodTables =
+      std::unordered_map<const SharedMethods*, std::weak_ptr<MethodTable>>;
+  static std::mutex mutex;
+  static std::unordered_map<jsi::Runtime*, RuntimeMethodTables> registry;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& weakMethodTable = registry[&rt][&methods];
+  methodTable_ = weakMethodTable.lock();
+  if (methodTable_ != nullptr) {
+    return;
+  }
+
+  // Drop registry entries of runtimes that no longer have live tables. This
+  // only happens on table creation, which is rare.
+  for (auto it = registry.begin(); it != registry.end();) {
+    auto& tables = it->second;
+    for (auto tableIt = tables.begin(); tableIt != tables.end();) {
+      tableIt = tableIt->second.expired() ? tables.erase(tableIt)
+                                          : std::next(tableIt);
+    }
+    it = tables.empty() ? registry.erase(it) : std::next(it);
+  }
+
+  methodTable_ = std::make_shared<MethodTable>(rt, methods, properties);
+  registry[&rt][&methods] = methodTable_;
+}
+
 } // namespace common
 } // namespace torchlive
@@ -9,8 +9,14 @@
 
 #include <jsi/jsi.h>
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+#include "ExternalMemory.h"
 
 namespace torchlive {
 namespace common {
@@ -19,6 +25,26 @@ namespace common {
 // properties like functions.
 class BaseHostObject : public facebook::jsi::HostObject {
  public:
+  // A method shared by all instances of a host object class. The host function
+  // is called with the host object as thisValue and must not capture instance
+  // state.
+  struct SharedMethod {
+    std::string name;
+    /**
+     * The paramCount parameter specifies the function.length property in JSI
+     * metadata, and is set to the the minimal required arg count of the
+     * function.
+     */
+    unsigned int paramCount;
+    facebook::jsi::HostFunctionType func;
+  };
+
+  using SharedMethods = std::vector<SharedMethod>;
+
+  // Names of properties that a host object class resolves in its own get(),
+  // e.g., computed properties like tensor.shape.
+  using SharedProperties = std::vector<std::string>;
+
   explicit BaseHostObject(facebook::jsi::Runtime& rt);
   virtual ~BaseHostObject();
 
@@ -29,6 +55,26 @@ class BaseHostObject : public facebook::jsi::HostObject {
   virtual std::vector<facebook::jsi::PropNameID> getPropertyNames(
       facebook::jsi::Runtime& rt) override;
 
+  /**
+   * Returns the native memory held by the host object, e.g., the storage of a
+   * tensor. utils::helpers::createFromHostObject reports it to the garbage
+   * collector, see common::reportExternalMemory.
+   */
+  virtual ExternalMemory getExternalMemory() const;
+
+  /**
+   * Reports the native memory for the object that wraps this host object.
+   */
+  void reportExternalMemory(
+      facebook::jsi::Runtime& rt,
+      const facebook::jsi::Object& object);
+
+  /**
+   * Releases the reported native memory, e.g., after it was freed explicitly.
+   * Otherwise, it is released when the host object is destroyed.
+   */
+  void releaseExternalMemory();
+
  protected:
   void setProperty(
       facebook::jsi::Runtime& rt,
@@ -46,7 +92,59 @@ class BaseHostObject : public facebook::jsi::HostObject {
       unsigned int paramCount,
       facebook::jsi::HostFunctionType func);
 
+  /**
+   * Exposes the given methods on this host object. The jsi::Function for each
+   * method is created lazily on first access and is shared by all host objects
+   * using the same methods list in the same runtime. The methods list is
+   * identified by its address and must outlive the runtime, i.e., it should be
+   * a static.
+   *
+   * The method names and the optional shared property names are interned once
+   * per runtime as jsi::PropNameID, so property lookups compare names with
+   * jsi::PropNameID::compare instead of converting them to strings.
+   */
+  void setSharedMethods(
+      facebook::jsi::Runtime& rt,
+      const SharedMethods& methods,
+      const SharedProperties& properties = {});
+
+  /**
+   * Returns the shared property name (see setSharedMethods) that equals the
+   * given name, or nullptr if the name is not a shared property.
+   */
+  const std::string* findSharedProperty(
+      facebook::jsi::Runtime& rt,
+      const facebook::jsi::PropNameID& name) const;
+
+  /**
+   * Returns the shared method (see setSharedMethods) with the given name, or
+   * undefined if the name is not a shared method.
+   */
+  facebook::jsi::Value getSharedMethod(
+      facebook::jsi::Runtime& rt,
+      const facebook::jsi::PropNameID& name);
+
+  /**
+   * Same as get(), but for callers that already converted the name to UTF-8.
+   */
+  facebook::jsi::Value get(
+      facebook::jsi::Runtime& rt,
+      const facebook::jsi::PropNameID& name,
+      const std::string& utf8Name);
+
+  /**
+   * Parses a property name like "42" as an index. Returns false, without
+   * throwing, if the name is not a non-negative decimal integer.
+   */
+  static bool parseIndex(const std::string& name, int64_t* index) noexcept;
+
   std::unordered_map<std::string, facebook::jsi::Value> propertyMap_;
+
+ private:
+  class MethodTable;
+
+  std::shared_ptr<MethodTable> methodTable_;
+  ExternalMemory externalMemory_ = {nullptr, 0};
 };
 
 } // namespace common
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "CancellationToken.h"
+
+#include <utility>
+
+namespace torchlive {
+namespace common {
+
+using namespace facebook;
+
+const char* const kCancellationErrorName = "AbortError";
+
+namespace {
+
+thread_local std::shared_ptr<CancellationToken> currentToken;
+
+} // namespace
+
+CancellationToken::Scope::Scope(std::shared_ptr<CancellationToken> token)
+    : previous_(std::move(currentToken)) {
+  currentToken = std::move(token);
+}
+
+CancellationToken::Scope::~Scope() {
+  currentToken = std::move(previous_);
+}
+
+CancellationToken::CancellationToken(
+    std::string reason,
+    std::shared_ptr<CancellationToken> parent)
+    : reason_(std::move(reason)), parent_(std::move(parent)) {}
+
+std::shared_ptr<CancellationToken> CancellationToken::fromAbortSignal(
+    jsi::Runtime& runtime,
+    const jsi::Value& signal) {
+  if (!signal.isObject()) {
+    throw jsi::JSError(runtime, "expect signal to be an AbortSignal");
+  }
+  auto signalObject = signal.asObject(runtime);
+  auto addEventListener = signalObject.getProperty(runtime, "addEventListener");
+  if (!addEventListener.isObject() ||
+      !addEventListener.asObject(runtime).isFunction(runtime)) {
+    throw jsi::JSError(runtime, "expect signal to be an AbortSignal");
+  }
+
+  auto token = std::make_shared<CancellationToken>("The operation was aborted");
+  auto aborted = signalObject.getProperty(runtime, "aborted");
+  if (aborted.isBool() && aborted.getBool()) {
+    token->cancel();
+    return token;
+  }
+
+  auto onAbort = jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forAscii(runtime, "onAbort"),
+      0,
+      [token](
+          jsi::Runtime& runtime,
+          const jsi::Value& thisValue,
+          const jsi::Value* arguments,
+          size_t count) {
+        token->cancel();
+        return jsi::Value::undefined();
+      });
+  addEventListener.asObject(runtime).asFunction(runtime).callWithThis(
+      runtime,
+      signalObject,
+      jsi::String::createFromAscii(runtime, "abort"),
+      std::move(onAbort));
+  return token;
+}
+
+std::shared_ptr<CancellationToken> CancellationToken::current() {
+  return currentToken;
+}
+
+void CancellationToken::cancel() noexcept {
+  cancelled_.store(true, std::memory_order_release);
+}
+
+const std::string* CancellationToken::cancellationReason() const noexcept {
+  for (auto token = this; token != nullptr; token = token->parent_.get()) {
+    if (token->cancelled_.load(std::memory_order_acquire)) {
+      return &token->reason_;
+    }
+  }
+  return nullptr;
+}
+
+} // namespace common
+} // namespace torchlive
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <jsi/jsi.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace torchlive {
+namespace common {
+
+// The name of the error that Promises of cancelled work are rejected with. It
+// matches the error name used for an aborted fetch.
+extern const char* const kCancellationErrorName;
+
+// A token to cancel async work before it starts. It is cancelled on the
+// JavaScript thread and checked on worker threads. A token is also cancelled
+// if its parent is cancelled.
+class CancellationToken {
+ public:
+  // Sets the token for the async work that the current thread schedules while
+  // the scope is alive. Scopes can be nested.
+  class Scope {
+   public:
+    explicit Scope(std::shared_ptr<CancellationToken> token);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    std::shared_ptr<CancellationToken> previous_;
+  };
+
+  explicit CancellationToken(
+      std::string reason,
+      std::shared_ptr<CancellationToken> parent = nullptr);
+
+  // Creates a token that is cancelled when the given JavaScript AbortSignal
+  // aborts.
+  static std::shared_ptr<CancellationToken> fromAbortSignal(
+      facebook::jsi::Runtime& runtime,
+      const facebook::jsi::Value& signal);
+
+  // Returns the token of the innermost Scope of the current thread, or nullptr
+  // if there is none.
+  static std::shared_ptr<CancellationToken> current();
+
+  void cancel() noexcept;
+
+  // Returns the reason of the first cancelled token in the parent chain, or
+  // nullptr if neither this token nor a parent is cancelled.
+  const std::string* cancellationReason() const noexcept;
+
+ private:
+  const std::string reason_;
+  const std::shared_ptr<CancellationToken> parent_;
+  std::atomic<bool> cancelled_{false};
+};
+
+} // namespace common
+} // namespace torchlive
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "CompletionQueue.h"
+
+#include <iterator>
+#include <utility>
+
+namespace torchlive {
+namespace common {
+
+using namespace facebook;
+
+CompletionQueue::CompletionQueue(RuntimeExecutor runtimeExecutor)
+    : runtimeExecutor_(std::move(runtimeExecutor)) {}
+
+RuntimeExecutor CompletionQueue::executor() {
+  auto self = shared_from_this();
+  return [self](Callback&& callback) { self->post(std::move(callback)); };
+}
+
+void CompletionQueue::post(Callback&& callback) {
+  bool schedule = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callbacks_.push_back(std::move(callback));
+    stats_.callbacks++;
+    if (!drainScheduled_) {
+      drainScheduled_ = true;
+      schedule = true;
+    }
+  }
+  if (schedule) {
+    scheduleDrain();
+  }
+}
+
+CompletionQueue::Stats CompletionQueue::stats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void CompletionQueue::scheduleDrain() {
+  auto self = shared_from_this();
+  runtimeExecutor_([self](jsi::Runtime& runtime) { self->drain(runtime); });
+}
+
+void CompletionQueue::drain(jsi::Runtime& runtime) {
+  std::deque<Callback> batch;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    batch.swap(callbacks_);
+    drainScheduled_ = false;
+    stats_.drains++;
+  }
+
+  while (!batch.empty()) {
+    auto callback = std::move(batch.front());
+    batch.pop_front();
+    try {
+      callback(runtime);
+    } catch (...) {
+      // Keep the behavior of an unbatched RuntimeExecutor, which sees the
+      // exception, but first hand the rest of the batch to another drain so
+      // that it still runs before any callback posted later.
+      if (!batch.empty()) {
+        bool schedule = false;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          callbacks_.insert(
+              callbacks_.begin(),
+              std::make_move_iterator(batch.begin()),
+              std::make_move_iterator(batch.end()));
+          if (!drainScheduled_) {
+            drainScheduled_ = true;
+            schedule = true;
+          }
+        }
+        if (schedule) {
+          scheduleDrain();
+        }
+      }
+      throw;
+    }
+  }
+}
+
+} // namespace common
+} // namespace torchlive
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <jsi/jsi.h>
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "../torchlive.h"
+
+namespace torchlive {
+namespace common {
+
+// Batches callbacks for the JavaScript thread. Callbacks posted from worker
+// threads (e.g., to resolve the Promise of an AsyncTask) are queued, and all
+// callbacks that are queued by the time the JavaScript thread gets to them
+// run in a single call of the underlying RuntimeExecutor. Callbacks run in the
+// order they were posted.
+class CompletionQueue : public std::enable_shared_from_this<CompletionQueue> {
+ public:
+  using Callback = std::function<void(facebook::jsi::Runtime& runtime)>;
+
+  struct Stats {
+    // Callbacks posted since the queue was created.
+    std::uint64_t callbacks;
+    // Calls of the underlying RuntimeExecutor, i.e., JavaScript thread hops.
+    std::uint64_t drains;
+  };
+
+  explicit CompletionQueue(RuntimeExecutor runtimeExecutor);
+
+  // Returns a RuntimeExecutor that posts callbacks to this queue. The executor
+  // keeps the queue alive.
+  RuntimeExecutor executor();
+
+  void post(Callback&& callback);
+
+  Stats stats();
+
+ private:
+  void scheduleDrain();
+  void drain(facebook::jsi::Runtime& runtime);
+
+  RuntimeExecutor runtimeExecutor_;
+  std::mutex mutex_;
+  std::deque<Callback> callbacks_;
+  bool drainScheduled_ = false;
+  Stats stats_ = {0, 0};
+};
+
+} // namespace common
+} // namespace torchlive
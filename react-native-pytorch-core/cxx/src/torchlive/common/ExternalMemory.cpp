@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <mutex>
+
+#include "CompletionQueue.h"
+#include "ExternalMemory.h"
+
+namespace torchlive {
+namespace common {
+
+using namespace facebook;
+
+namespace {
+
+// The budget grows to at most this multiple of the configured budget while
+// garbage collections don't free memory.
+constexpr std::size_t kMaxBudgetScale = 16;
+
+// Reported memory ranges, by start address. Each range counts the host objects
+// that hold memory within it.
+struct Range {
+  std::size_t size;
+  std::size_t holders;
+};
+
+// Host objects are destroyed on any thread, e.g., when a task that holds one
+// completes, so the state is locked.
+std::mutex mutex;
+std::map<std::uintptr_t, Range> ranges;
+std::size_t reportedBytes = 0;
+std::size_t budget = 64 * 1024 * 1024;
+
+#ifndef TORCHLIVE_JSI_EXTERNAL_MEMORY
+// The reported bytes after the last garbage collection, lowered by the frees
+// since then, and the growth beyond them that requests the next collection.
+std::size_t baselineBytes = 0;
+std::size_t scaledBudget = budget;
+bool checkScheduled = false;
+
+// Runs in a task on the JavaScript thread, after the task that reported the
+// memory that exceeded the budget.
+void checkExternalMemory(jsi::Runtime& runtime) {
+  std::size_t before;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    checkScheduled = false;
+    if (reportedBytes - baselineBytes < scaledBudget) {
+      return;
+    }
+    before = reportedBytes;
+  }
+
+  // The garbage collection finalizes the unreachable host objects, which
+  // releases their memory.
+  runtime.instrumentation().collectGarbage("torchlive external memory");
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto growth = before - baselineBytes;
+  auto freed = before > reportedBytes ? before - reportedBytes : 0;
+  if (freed < growth / 2) {
+    auto maxBudget = budget > std::numeric_limits<std::size_t>::max() /
+            kMaxBudgetScale
+        ? std::numeric_limits<std::size_t>::max()
+        : budget * kMaxBudgetScale;
+    scaledBudget = scaledBudget > maxBudget / 2 ? maxBudget : scaledBudget * 2;
+  } else {
+    scaledBudget = budget;
+  }
+  baselineBytes = reportedBytes;
+}
+#endif
+
+} // namespace
+
+ExternalMemory reportExternalMemory(
+    jsi::Runtime& runtime,
+    const jsi::Object& object,
+    ExternalMemory memory) {
+  if (memory.size == 0) {
+    return {nullptr, 0};
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (memory.data != nullptr) {
+      auto start = reinterpret_cast<std::uintptr_t>(memory.data);
+      auto it = ranges.upper_bound(start);
+      if (it != ranges.begin()) {
+        --it;
+        if (start + memory.size <= it->first + it->second.size) {
+          // The memory is part of reported memory, e.g., a tensor view.
+          it->second.holders++;
+          return {reinterpret_cast<const void*>(it->first), 0};
+        }
+      }
+      ranges[start] = {memory.size, 1};
+    }
+    reportedBytes += memory.size;
+
+#ifndef TORCHLIVE_JSI_EXTERNAL_MEMORY
+    if (reportedBytes - baselineBytes < scaledBudget || checkScheduled) {
+      return memory;
+    }
+    checkScheduled = true;
+#endif
+  }
+
+#ifdef TORCHLIVE_JSI_EXTERNAL_MEMORY
+  object.setExternalMemoryPressure(runtime, memory.size);
+#else
+  // Collecting garbage in the host function that created the object would
+  // stall every call while the memory is reachable, so the budget is checked
+  // once, after the current task.
+  auto completionQueue = findCompletionQueue(runtime);
+  if (completionQueue != nullptr) {
+    completionQueue->post(checkExternalMemory);
+  } else {
+    // The runtime has no bindings installed, e.g., in tests that create host
+    // objects directly. Creating the object must not fail because of that,
+    // so the check is left to a later report.
+    std::lock_guard<std::mutex> lock(mutex);
+    checkScheduled = false;
+  }
+#endif
+  return memory;
+}
+
+void releaseExternalMemory(ExternalMemory handle) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (handle.data != nullptr) {
+    auto it = ranges.find(reinterpret_cast<std::uintptr_t>(handle.data));
+    if (it == ranges.end() || --it->second.holders > 0) {
+      return;
+    }
+    handle.size = it->second.size;
+    ranges.erase(it);
+  }
+  reportedBytes -= std::min(handle.size, reportedBytes);
+#ifndef TORCHLIVE_JSI_EXTERNAL_MEMORY
+  baselineBytes = std::min(baselineBytes, reportedBytes);
+#endif
+}
+
+void detachExternalMemory(jsi::Runtime& runtime, const jsi::Object& object) {
+#ifdef TORCHLIVE_JSI_EXTERNAL_MEMORY
+  object.setExternalMemoryPressure(runtime, 0);
+#endif
+}
+
+void setExternalMemoryBudget(std::size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex);
+  budget = bytes;
+#ifndef TORCHLIVE_JSI_EXTERNAL_MEMORY
+  scaledBudget = bytes;
+#endif
+}
+
+std::size_t getExternalMemoryBudget() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return budget;
+}
+
+std::size_t getReportedExternalMemory() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return reportedBytes;
+}
+
+} // namespace common
+} // namespace torchlive
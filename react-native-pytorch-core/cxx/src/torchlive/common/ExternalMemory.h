@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <jsi/jsi.h>
+
+#include <cstddef>
+
+namespace torchlive {
+namespace common {
+
+/**
+ * Native memory held by a host object. Host objects that share memory, e.g., a
+ * tensor and its views, or a blob and its slices, describe it with the memory
+ * range they point into, so it is only reported once. Memory that can't be
+ * shared has a null data pointer.
+ */
+struct ExternalMemory {
+  const void* data;
+  std::size_t size;
+};
+
+/**
+ * Reports the native memory held by the host object of a JavaScript object to
+ * the garbage collector. The garbage collector otherwise only sees the small
+ * host object, and runs too rarely while native memory grows. Memory within
+ * memory that is already reported is not reported again. Returns the handle
+ * to pass to releaseExternalMemory when the memory is no longer held.
+ *
+ * With JSI external memory support (TORCHLIVE_JSI_EXTERNAL_MEMORY), the bytes
+ * are attached to the object. Without it, the reported bytes that have not
+ * been released are compared against the external memory budget in a task
+ * on the JavaScript thread, which requests a garbage collection if they grew
+ * by more than the budget since the last one. The budget doubles while the
+ * collections free less than half of that growth, i.e., while the memory is
+ * still reachable.
+ */
+ExternalMemory reportExternalMemory(
+    facebook::jsi::Runtime& runtime,
+    const facebook::jsi::Object& object,
+    ExternalMemory memory);
+
+/**
+ * Releases memory reported by reportExternalMemory, e.g., when its host object
+ * is destroyed. Can be called on any thread.
+ */
+void releaseExternalMemory(ExternalMemory handle);
+
+/**
+ * Detaches the bytes attached to the object with JSI external memory support,
+ * e.g., after a tensor is disposed. Does nothing without it.
+ */
+void detachExternalMemory(
+    facebook::jsi::Runtime& runtime,
+    const facebook::jsi::Object& object);
+
+/**
+ * Sets the growth of the reported bytes without JSI external memory support
+ * before a garbage collection is requested. Defaults to 64 MiB.
+ */
+void setExternalMemoryBudget(std::size_t bytes);
+
+std::size_t getExternalMemoryBudget();
+
+/**
+ * Returns the reported bytes that have not been released.
+ */
+std::size_t getReportedExternalMemory();
+
+} // namespace common
+} // namespace torchlive
@@ -7,6 +7,9 @@
 
 #include "ExperimentalNamespace.h"
 #include "../Promise.h"
+#include "../ThreadPool.h"
+#include "../common/CancellationToken.h"
+#include "../common/CompletionQueue.h"
 #include "../media/NativeJSRefBridge.h"
 #include "../media/audio/AudioHostObject.h"
 #include "../torch/utils/ArgumentParser.h"
@@ -82,12 +85,108 @@ static Value audioRemoveWAVHeaderImpl(
 
 } // namespace audio
 
+namespace scheduling {
+
+static Object createLaneStats(
+    Runtime& runtime,
+    const ThreadPool::LaneStats& laneStats) {
+  Object obj(runtime);
+  obj.setProperty(runtime, "queued", static_cast<double>(laneStats.queued));
+  obj.setProperty(runtime, "running", static_cast<double>(laneStats.running));
+  obj.setProperty(
+      runtime, "completed", static_cast<double>(laneStats.completed));
+  return obj;
+}
+
+static Value threadPoolStatsImpl(
+    Runtime& runtime,
+    const Value& thisValue,
+    const Value* arguments,
+    size_t count) {
+  auto stats = ThreadPool::pool()->stats();
+  Object obj(runtime);
+  obj.setProperty(
+      runtime, "interactive", createLaneStats(runtime, stats.interactive));
+  obj.setProperty(
+      runtime, "background", createLaneStats(runtime, stats.background));
+  return obj;
+}
+
+static Value completionQueueStatsImpl(
+    Runtime& runtime,
+    const Value& thisValue,
+    const Value* arguments,
+    size_t count) {
+  auto stats = getCompletionQueue(runtime)->stats();
+  Object obj(runtime);
+  obj.setProperty(runtime, "callbacks", static_cast<double>(stats.callbacks));
+  obj.setProperty(runtime, "drains", static_cast<double>(stats.drains));
+  obj.setProperty(
+      runtime,
+      "coalesced",
+      static_cast<double>(stats.callbacks - stats.drains));
+  return obj;
+}
+
+static Value withPriorityImpl(
+    Runtime& runtime,
+    const Value& thisValue,
+    const Value* arguments,
+    size_t count) {
+  auto args = utils::ArgumentParser(runtime, thisValue, arguments, count);
+  args.requireNumArguments(2);
+
+  auto priorityName = args[0].asString(runtime).utf8(runtime);
+  ThreadPool::Priority priority;
+  if (priorityName == "interactive") {
+    priority = ThreadPool::Priority::kInteractive;
+  } else if (priorityName == "background") {
+    priority = ThreadPool::Priority::kBackground;
+  } else {
+    throw JSError(
+        runtime,
+        "expect priority to be 'interactive' or 'background', but got '" +
+            priorityName + "'");
+  }
+  auto func = args[1].asObject(runtime).asFunction(runtime);
+
+  // Async functions called by func schedule their work when they are called,
+  // so the scope only needs to cover the synchronous part of func.
+  ThreadPool::PriorityScope scope(priority);
+  return func.call(runtime);
+}
+
+static Value withSignalImpl(
+    Runtime& runtime,
+    const Value& thisValue,
+    const Value* arguments,
+    size_t count) {
+  auto args = utils::ArgumentParser(runtime, thisValue, arguments, count);
+  args.requireNumArguments(2);
+
+  auto token = common::CancellationToken::fromAbortSignal(runtime, args[0]);
+  auto func = args[1].asObject(runtime).asFunction(runtime);
+
+  common::CancellationToken::Scope scope(std::move(token));
+  return func.call(runtime);
+}
+
+} // namespace scheduling
+
 Object buildNamespace(Runtime& rt, RuntimeExecutor rte) {
   Object obj(rt);
   setPropertyHostFunction(
       rt, obj, "audioFromBytes", 2, audio::audioFromBytesImpl);
   setPropertyHostFunction(
       rt, obj, "audioRemoveWAVHeader", 1, audio::audioRemoveWAVHeaderImpl);
+  setPropertyHostFunction(
+      rt, obj, "completionQueueStats", 0, scheduling::completionQueueStatsImpl);
+  setPropertyHostFunction(
+      rt, obj, "threadPoolStats", 0, scheduling::threadPoolStatsImpl);
+  setPropertyHostFunction(
+      rt, obj, "withPriority", 2, scheduling::withPriorityImpl);
+  setPropertyHostFunction(
+      rt, obj, "withSignal", 2, scheduling::withSignalImpl);
   return obj;
 }
 
@@ -7,6 +7,11 @@
 
 #include "FilesystemNamespace.h"
 #include <sys/stat.h>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
 #include "../Promise.h"
 #include "../torch/utils/ArgumentParser.h"
 #include "../torch/utils/helpers.h"
@@ -19,6 +24,9 @@ using namespace utils::helpers;
 
 namespace {
 
+std::mutex cacheDirectoryMutex;
+std::string cacheDirectory;
+
 Value getLastAccessTimeImpl(
     Runtime& runtime,
     const Value& thisValue,
@@ -44,6 +52,28 @@ Value getLastAccessTimeImpl(
 
 } // namespace
 
+void setCacheDirectory(const std::string& path) {
+  std::lock_guard<std::mutex> lock(cacheDirectoryMutex);
+  cacheDirectory = path;
+}
+
+std::string getCacheDirectory() {
+  std::lock_guard<std::mutex> lock(cacheDirectoryMutex);
+  return cacheDirectory;
+}
+
+void writeFile(const std::string& path, const std::string& contents) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (file) {
+    file.write(contents.data(), contents.size());
+    file.close();
+  }
+  if (!file) {
+    throw std::runtime_error(
+        "can't write file " + path + ": " + std::strerror(errno));
+  }
+}
+
 Object buildNamespace(Runtime& rt, RuntimeExecutor rte) {
   Object obj(rt);
   setPropertyHostFunction(
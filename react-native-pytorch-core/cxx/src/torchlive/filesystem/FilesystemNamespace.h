@@ -9,6 +9,8 @@
 
 #include <jsi/jsi.h>
 
+#include <string>
+
 #include "../torchlive.h"
 
 namespace torchlive {
@@ -18,5 +20,17 @@ facebook::jsi::Object buildNamespace(
     facebook::jsi::Runtime& rt,
     RuntimeExecutor rte);
 
+// Sets the directory of the app for cached files, e.g., tuned thread counts of
+// models. The platform sets it before install. Files in it can be deleted by
+// the system, so they must be recreatable.
+void setCacheDirectory(const std::string& path);
+
+// Returns the cache directory, or an empty string if it was not set.
+std::string getCacheDirectory();
+
+// Writes the contents to the file at the given path, replacing an existing
+// file. Throws std::runtime_error if the file can't be written.
+void writeFile(const std::string& path, const std::string& contents);
+
 } // namespace filesystem
 } // namespace torchlive
@@ -14,12 +14,24 @@ Blob::Blob(
     std::unique_ptr<uint8_t[]>&& buffer,
     size_t byteLength,
     const std::string& type)
+    : buffer_(buffer.release(), std::default_delete<uint8_t[]>()),
+      byteLength_(byteLength),
+      type_(type) {}
+
+Blob::Blob(
+    std::shared_ptr<uint8_t> buffer,
+    size_t byteLength,
+    const std::string& type)
     : buffer_(std::move(buffer)), byteLength_(byteLength), type_(type) {}
 
 uint8_t* Blob::getDirectBytes() const {
   return buffer_.get();
 }
 
+std::shared_ptr<uint8_t> Blob::getSharedBytes() const noexcept {
+  return buffer_;
+}
+
 size_t Blob::getDirectSize() const noexcept {
   return byteLength_;
 }
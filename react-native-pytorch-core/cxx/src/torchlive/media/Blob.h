@@ -29,12 +29,21 @@ class Blob {
       size_t byteLength,
       const std::string& type = "");
 
+  Blob(
+      std::shared_ptr<uint8_t> buffer,
+      size_t byteLength,
+      const std::string& type = "");
+
   uint8_t* getDirectBytes() const;
   size_t getDirectSize() const noexcept;
   const std::string& getType() const noexcept;
 
+  // Returns a reference-counted pointer to the blob data. It keeps the data
+  // alive after the blob is destroyed, e.g., for tensors created from the blob.
+  std::shared_ptr<uint8_t> getSharedBytes() const noexcept;
+
  private:
-  std::unique_ptr<uint8_t[]> buffer_;
+  std::shared_ptr<uint8_t> buffer_;
   size_t byteLength_;
   std::string type_;
 };
@@ -21,9 +21,8 @@ namespace {
 jsi::Value BlobObjectWithNoData(jsi::Runtime& runtime) {
   // `Blob` has size 0 and contains no data.
   auto buffer = std::unique_ptr<uint8_t[]>(new uint8_t[0]);
-  auto blobHostObject = std::make_shared<BlobHostObject>(
+  return utils::helpers::createFromHostObject<BlobHostObject>(
       runtime, std::make_unique<Blob>(std::move(buffer), 0));
-  return jsi::Object::createFromHostObject(runtime, std::move(blobHostObject));
 }
 
 } // namespace
@@ -94,16 +93,22 @@ static jsi::Value sliceImpl(
     return BlobObjectWithNoData(runtime);
   }
 
-  // Implement slice(start, end)
+  // Implement slice(start, end). The sliced blob shares the data with the
+  // source blob, which is never modified after creation.
   auto size = end - start;
-  auto buffer = std::unique_ptr<uint8_t[]>(new uint8_t[size]);
-  std::memcpy(buffer.get(), blob->getDirectBytes() + start, size);
+  auto data = blob->getSharedBytes();
+  auto buffer = std::shared_ptr<uint8_t>(data, data.get() + start);
 
-  auto blobHostObject = std::make_shared<BlobHostObject>(
+  return utils::helpers::createFromHostObject<BlobHostObject>(
       runtime, std::make_unique<Blob>(std::move(buffer), size));
-  return jsi::Object::createFromHostObject(runtime, std::move(blobHostObject));
 }
 
+// BlobHostObject Methods
+static const common::BaseHostObject::SharedMethods METHODS = {
+    {"arrayBuffer", 0, arrayBufferImpl},
+    {"slice", 0, sliceImpl},
+};
+
 BlobHostObject::BlobHostObject(
     jsi::Runtime& runtime,
     std::unique_ptr<torchlive::media::Blob>&& b)
@@ -114,8 +119,12 @@ BlobHostObject::BlobHostObject(
       runtime, "type", jsi::String::createFromUtf8(runtime, blob->getType()));
 
   // Functions
-  setPropertyHostFunction(runtime, "arrayBuffer", 0, arrayBufferImpl);
-  setPropertyHostFunction(runtime, "slice", 0, sliceImpl);
+  setSharedMethods(runtime, METHODS);
+}
+
+common::ExternalMemory BlobHostObject::getExternalMemory() const {
+  // Slices point into the memory of the source blob.
+  return {blob->getDirectBytes(), blob->getDirectSize()};
 }
 
 } // namespace media
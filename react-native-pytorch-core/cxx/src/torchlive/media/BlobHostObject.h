@@ -22,6 +22,8 @@ class JSI_EXPORT BlobHostObject : public torchlive::common::BaseHostObject {
       facebook::jsi::Runtime& runtime,
       std::unique_ptr<torchlive::media::Blob>&& b);
 
+  common::ExternalMemory getExternalMemory() const override;
+
   std::unique_ptr<torchlive::media::Blob> blob;
 };
 
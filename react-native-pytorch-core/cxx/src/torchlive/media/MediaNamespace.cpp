@@ -212,9 +212,8 @@ jsi::Value toBlobImpl(
       throw jsi::JSError(runtime, e.what());
     }
   }
-  auto blobHostObject = std::make_shared<torchlive::media::BlobHostObject>(
+  return utils::helpers::createFromHostObject<BlobHostObject>(
       runtime, std::move(blob));
-  return jsi::Object::createFromHostObject(runtime, std::move(blobHostObject));
 }
 
 } // namespace
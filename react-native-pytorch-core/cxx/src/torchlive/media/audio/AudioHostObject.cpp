@@ -92,6 +92,15 @@ jsi::Value releaseImpl(
 
 } // namespace
 
+// AudioHostObject Methods
+static const common::BaseHostObject::SharedMethods METHODS = {
+    {"play", 0, playImpl},
+    {"pause", 0, pauseImpl},
+    {"stop", 0, stopImpl},
+    {"getDuration", 0, getDurationImpl},
+    {"release", 0, releaseImpl},
+};
+
 AudioHostObject::AudioHostObject(
     jsi::Runtime& runtime,
     std::shared_ptr<IAudio> audio)
@@ -101,11 +110,7 @@ AudioHostObject::AudioHostObject(
       runtime, "ID", jsi::String::createFromUtf8(runtime, audio_->getId()));
 
   // Functions
-  setPropertyHostFunction(runtime, "play", 0, playImpl);
-  setPropertyHostFunction(runtime, "pause", 0, pauseImpl);
-  setPropertyHostFunction(runtime, "stop", 0, stopImpl);
-  setPropertyHostFunction(runtime, "getDuration", 0, getDurationImpl);
-  setPropertyHostFunction(runtime, "release", 0, releaseImpl);
+  setSharedMethods(runtime, METHODS);
 }
 
 std::shared_ptr<IAudio> AudioHostObject::getAudio() const noexcept {
@@ -8,6 +8,7 @@
 #include "ImageHostObject.h"
 
 #include "../../Promise.h"
+#include "../../common/ExternalMemory.h"
 #include "../../torch/utils/ArgumentParser.h"
 #include "../../torch/utils/helpers.h"
 
@@ -99,9 +100,12 @@ jsi::Value releaseImpl(
     const jsi::Value& thisValue,
     const jsi::Value* arguments,
     size_t count) {
-  auto image = thisValue.asObject(runtime)
-                   .asHostObject<ImageHostObject>(runtime)
-                   ->getImage();
+  auto imageHostObject =
+      thisValue.asObject(runtime).asHostObject<ImageHostObject>(runtime);
+  auto image = imageHostObject->getImage();
+  // The bitmap is closed, so its memory is no longer held by the object.
+  imageHostObject->releaseExternalMemory();
+  common::detachExternalMemory(runtime, thisValue.asObject(runtime));
   auto promiseValue = torchlive::createPromiseAsJSIValue(
       runtime,
       [image](jsi::Runtime& rt, std::shared_ptr<torchlive::Promise> promise) {
@@ -121,6 +125,17 @@ jsi::Value releaseImpl(
 
 } // namespace
 
+// ImageHostObject Methods
+static const common::BaseHostObject::SharedMethods METHODS = {
+    {"getHeight", 0, getHeightImpl},
+    {"getNaturalHeight", 0, getNaturalHeightImpl},
+    {"getNaturalWidth", 0, getNaturalWidthImpl},
+    {"getPixelDensity", 0, getPixelDensityImpl},
+    {"getWidth", 0, getWidthImpl},
+    {"release", 0, releaseImpl},
+    {"scale", 2, scaleImpl},
+};
+
 ImageHostObject::ImageHostObject(
     jsi::Runtime& runtime,
     std::shared_ptr<IImage> image)
@@ -130,18 +145,20 @@ ImageHostObject::ImageHostObject(
       runtime, "ID", jsi::String::createFromUtf8(runtime, image_->getId()));
 
   // Functions
-  setPropertyHostFunction(runtime, "getHeight", 0, getHeightImpl);
-  setPropertyHostFunction(runtime, "getNaturalHeight", 0, getNaturalHeightImpl);
-  setPropertyHostFunction(runtime, "getNaturalWidth", 0, getNaturalWidthImpl);
-  setPropertyHostFunction(runtime, "getPixelDensity", 0, getPixelDensityImpl);
-  setPropertyHostFunction(runtime, "getWidth", 0, getWidthImpl);
-  setPropertyHostFunction(runtime, "release", 0, releaseImpl);
-  setPropertyHostFunction(runtime, "scale", 2, scaleImpl);
+  setSharedMethods(runtime, METHODS);
 }
 
 std::shared_ptr<IImage> ImageHostObject::getImage() const noexcept {
   return image_;
 }
 
+common::ExternalMemory ImageHostObject::getExternalMemory() const {
+  // The bitmap of the image has 4 bytes per pixel (RGBA).
+  return {
+      nullptr,
+      static_cast<std::size_t>(
+          image_->getNaturalWidth() * image_->getNaturalHeight() * 4)};
+}
+
 } // namespace media
 } // namespace torchlive
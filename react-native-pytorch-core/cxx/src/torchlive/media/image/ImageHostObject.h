@@ -22,6 +22,8 @@ class JSI_EXPORT ImageHostObject : public common::BaseHostObject {
 
   std::shared_ptr<IImage> getImage() const noexcept;
 
+  common::ExternalMemory getExternalMemory() const override;
+
  private:
   std::shared_ptr<IImage> image_;
 };
@@ -7,6 +7,7 @@
 
 #include "DictHostObject.h"
 #include "IValueHostObject.h"
+#include "../common/BaseHostObject.h"
 
 namespace torchlive {
 namespace torch {
@@ -44,7 +45,17 @@ jsi::Value DictHostObject::get(
     jsi::Runtime& runtime,
     const jsi::PropNameID& propName) {
   auto key = propName.utf8(runtime);
-  auto it = this->dict_.find(key);
+  auto it = this->dict_.end();
+  int64_t index;
+  if (this->dict_.keyType()->kind() == c10::TypeKind::IntType &&
+      common::BaseHostObject::parseIndex(
+          key[0] == '-' ? key.substr(1) : key, &index)) {
+    // JavaScript property names are strings, so integer keys are parsed
+    // before the lookup (e.g., dict[1] in JavaScript is dict['1']).
+    it = this->dict_.find(key[0] == '-' ? -index : index);
+  } else {
+    it = this->dict_.find(key);
+  }
   if (it != this->dict_.end()) {
     auto valueHostObject = std::make_shared<torchlive::torch::IValueHostObject>(
         runtime, it->value());
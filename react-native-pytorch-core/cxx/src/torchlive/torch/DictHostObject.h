@@ -28,6 +28,10 @@ class JSI_EXPORT DictHostObject : public facebook::jsi::HostObject {
   std::vector<facebook::jsi::PropNameID> getPropertyNames(
       facebook::jsi::Runtime& rt) override;
 
+  const c10::Dict<at::IValue, at::IValue>& dict() const {
+    return dict_;
+  }
+
  private:
   c10::Dict<at::IValue, at::IValue> dict_;
 };
@@ -8,6 +8,7 @@
 #include "IValueHostObject.h"
 #include "DictHostObject.h"
 #include "TensorHostObject.h"
+#include "utils/helpers.h"
 
 namespace torchlive {
 namespace torch {
@@ -59,10 +60,8 @@ jsi::Value toTensorImpl(
   auto thiz =
       thisValue.asObject(runtime).asHostObject<IValueHostObject>(runtime);
   auto tensor = thiz->value.toTensor();
-  auto tensorHostObject = std::make_shared<torchlive::torch::TensorHostObject>(
+  return utils::helpers::createFromHostObject<TensorHostObject>(
       runtime, std::move(tensor));
-  return jsi::Object::createFromHostObject(
-      runtime, std::move(tensorHostObject));
 }
 
 jsi::Value toTupleImpl(
@@ -89,12 +88,17 @@ jsi::Value toTupleImpl(
 
 } // namespace
 
+// IValueHostObject Methods
+static const common::BaseHostObject::SharedMethods METHODS = {
+    {"toGenericDict", 0, toGenericDictImpl},
+    {"toList", 0, toListImpl},
+    {"toTensor", 0, toTensorImpl},
+    {"toTuple", 0, toTupleImpl},
+};
+
 IValueHostObject::IValueHostObject(jsi::Runtime& runtime, at::IValue v)
     : BaseHostObject(runtime), value(std::move(v)) {
-  setPropertyHostFunction(runtime, "toGenericDict", 0, toGenericDictImpl);
-  setPropertyHostFunction(runtime, "toList", 0, toListImpl);
-  setPropertyHostFunction(runtime, "toTensor", 0, toTensorImpl);
-  setPropertyHostFunction(runtime, "toTuple", 0, toTupleImpl);
+  setSharedMethods(runtime, METHODS);
 }
 
 } // namespace torch
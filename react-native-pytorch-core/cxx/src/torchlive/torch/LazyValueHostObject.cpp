@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "LazyValueHostObject.h"
+#include "utils/converter.h"
+
+namespace torchlive {
+namespace torch {
+
+using namespace facebook;
+
+namespace {
+
+static const std::string LENGTH = "length";
+
+// Returns the property name of a dict key, like ivalueToJSIValue does for
+// dicts converted to objects, or an empty string for other key types.
+std::string dictKeyName(const at::IValue& key) {
+  if (key.isString()) {
+    return key.toStringRef();
+  } else if (key.isInt()) {
+    return std::to_string(key.toInt());
+  } else if (key.isDouble()) {
+    return std::to_string(key.toDouble());
+  }
+  return "";
+}
+
+std::size_t containerSize(const at::IValue& value) {
+  if (value.isList()) {
+    return value.toListRef().size();
+  } else if (value.isTuple()) {
+    return value.toTupleRef().elements().size();
+  }
+  return 0;
+}
+
+jsi::Value toJSONImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  auto thiz =
+      thisValue.asObject(runtime).asHostObject<LazyValueHostObject>(runtime);
+  return utils::converter::ivalueToJSIValue(runtime, thiz->value);
+}
+
+} // namespace
+
+// LazyValueHostObject Methods
+static const common::BaseHostObject::SharedMethods METHODS = {
+    // Converts the whole value like an output without lazy conversion, which
+    // also makes JSON.stringify work.
+    {"toJSON", 0, toJSONImpl},
+};
+
+LazyValueHostObject::LazyValueHostObject(jsi::Runtime& runtime, at::IValue v)
+    : BaseHostObject(runtime), value(std::move(v)) {
+  setSharedMethods(runtime, METHODS);
+}
+
+c10::optional<at::IValue> LazyValueHostObject::findElement(
+    const std::string& name) const {
+  if (value.isGenericDict()) {
+    auto dict = value.toGenericDict();
+    auto keyKind = dict.keyType()->kind();
+    int64_t index;
+    if (keyKind == c10::TypeKind::StringType) {
+      auto it = dict.find(name);
+      if (it != dict.end()) {
+        return it->value();
+      }
+    } else if (
+        keyKind == c10::TypeKind::IntType && !name.empty() &&
+        parseIndex(name[0] == '-' ? name.substr(1) : name, &index)) {
+      auto it = dict.find(name[0] == '-' ? -index : index);
+      if (it != dict.end()) {
+        return it->value();
+      }
+    } else {
+      for (const auto& entry : dict) {
+        if (dictKeyName(entry.key()) == name) {
+          return entry.value();
+        }
+      }
+    }
+    return c10::nullopt;
+  }
+
+  int64_t index;
+  if (!parseIndex(name, &index) ||
+      static_cast<std::size_t>(index) >= containerSize(value)) {
+    return c10::nullopt;
+  }
+  if (value.isList()) {
+    return value.toListRef()[index];
+  }
+  return value.toTupleRef().elements()[index];
+}
+
+jsi::Value LazyValueHostObject::get(
+    jsi::Runtime& runtime,
+    const jsi::PropNameID& propName) {
+  auto name = propName.utf8(runtime);
+  auto cached = elements_.find(name);
+  if (cached != elements_.end()) {
+    return jsi::Value(runtime, cached->second);
+  }
+  if (!value.isGenericDict() && name == LENGTH) {
+    return static_cast<double>(containerSize(value));
+  }
+  auto element = findElement(name);
+  if (!element.has_value()) {
+    return BaseHostObject::get(runtime, propName, name);
+  }
+  auto result = utils::converter::ivalueToLazyJSIValue(runtime, *element);
+  elements_.emplace(name, jsi::Value(runtime, result));
+  return result;
+}
+
+std::vector<jsi::PropNameID> LazyValueHostObject::getPropertyNames(
+    jsi::Runtime& runtime) {
+  auto result = BaseHostObject::getPropertyNames(runtime);
+  if (value.isGenericDict()) {
+    for (const auto& entry : value.toGenericDict()) {
+      auto name = dictKeyName(entry.key());
+      if (!name.empty()) {
+        result.push_back(jsi::PropNameID::forUtf8(runtime, name));
+      }
+    }
+    return result;
+  }
+  auto size = containerSize(value);
+  for (std::size_t i = 0; i < size; i++) {
+    result.push_back(jsi::PropNameID::forUtf8(runtime, std::to_string(i)));
+  }
+  result.push_back(jsi::PropNameID::forUtf8(runtime, LENGTH));
+  return result;
+}
+
+} // namespace torch
+} // namespace torchlive
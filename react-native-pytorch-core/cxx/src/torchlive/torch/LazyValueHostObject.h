@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <jsi/jsi.h>
+
+// Suppress deprecated-declarations error to support Clang/C++17
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#include <torch/script.h>
+#pragma clang diagnostic pop
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../common/BaseHostObject.h"
+
+namespace torchlive {
+namespace torch {
+
+// A dict, list or tuple of a model output that converts its elements to
+// JavaScript values on property access. Dict entries are properties named by
+// their keys, and list and tuple elements are properties named by their
+// indices, next to a length property. Nested containers are lazy as well.
+//
+// Elements are converted once, so repeated accesses return the same value.
+class JSI_EXPORT LazyValueHostObject : public common::BaseHostObject {
+ public:
+  explicit LazyValueHostObject(facebook::jsi::Runtime& runtime, at::IValue v);
+
+  facebook::jsi::Value get(
+      facebook::jsi::Runtime& runtime,
+      const facebook::jsi::PropNameID& name) override;
+
+  std::vector<facebook::jsi::PropNameID> getPropertyNames(
+      facebook::jsi::Runtime& runtime) override;
+
+  at::IValue value;
+
+ private:
+  // Returns the element for the property name, if any.
+  c10::optional<at::IValue> findElement(const std::string& name) const;
+
+  std::unordered_map<std::string, facebook::jsi::Value> elements_;
+};
+
+} // namespace torch
+} // namespace torchlive
@@ -8,7 +8,17 @@
 #include <c10/core/MemoryFormat.h>
 #include <c10/util/Optional.h>
 
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+#include "../common/AsyncTask.h"
+#include "../common/ExternalMemory.h"
+#include "../torchlive.h"
 #include "TensorHostObject.h"
+#include "TensorScope.h"
+#include "jit/mobile/IntraOpThreads.h"
 #include "utils/ArgumentParser.h"
 #include "utils/constants.h"
 #include "utils/helpers.h"
@@ -19,25 +29,90 @@ namespace torch_ = torch;
 namespace torchlive {
 namespace torch {
 
-// TensorHostObject Method Names
-static const std::string SIZE = "size";
-static const std::string TOSTRING = "toString";
-
 // TensorHostObject Property Names
-static const std::string DATA = "data";
+static const std::string DISPOSE = "dispose";
 static const std::string DTYPE = "dtype";
 static const std::string SHAPE = "shape";
 
 // TensorHostObject Properties
-static const std::vector<std::string> PROPERTIES = {DATA, DTYPE, SHAPE};
-
-// TensorHostObject Methods
-static const std::vector<std::string> METHODS = {SIZE, TOSTRING};
+static const common::BaseHostObject::SharedProperties PROPERTIES = {
+    DTYPE,
+    SHAPE};
 
 using namespace facebook;
 
 namespace {
 
+#ifdef TORCHLIVE_JSI_MUTABLE_BUFFER
+// A jsi::MutableBuffer that aliases the storage of a contiguous tensor. The
+// buffer holds a reference to the tensor, which keeps the storage alive for as
+// long as the JavaScript ArrayBuffer is reachable.
+class TensorBuffer : public jsi::MutableBuffer {
+ public:
+  explicit TensorBuffer(torch_::Tensor tensor) : tensor_(std::move(tensor)) {}
+
+  size_t size() const override {
+    return tensor_.nbytes();
+  }
+
+  uint8_t* data() override {
+    return static_cast<uint8_t*>(tensor_.data_ptr());
+  }
+
+ private:
+  torch_::Tensor tensor_;
+};
+#endif
+
+jsi::ArrayBuffer createArrayBuffer(
+    jsi::Runtime& runtime,
+    const torch_::Tensor& tensor,
+    bool copy) {
+  // The ArrayBuffer holds the elements in row-major order, which is why a
+  // non-contiguous tensor (e.g., a permuted view) is made contiguous first.
+  auto contiguousTensor = tensor.contiguous();
+
+#ifdef TORCHLIVE_JSI_MUTABLE_BUFFER
+  if (!copy) {
+    return jsi::ArrayBuffer(
+        runtime, std::make_shared<TensorBuffer>(std::move(contiguousTensor)));
+  }
+#endif
+
+  int byteLength = contiguousTensor.nbytes();
+  jsi::ArrayBuffer buffer = runtime.global()
+                                .getPropertyAsFunction(runtime, "ArrayBuffer")
+                                .callAsConstructor(runtime, byteLength)
+                                .asObject(runtime)
+                                .getArrayBuffer(runtime);
+  std::memcpy(buffer.data(runtime), contiguousTensor.data_ptr(), byteLength);
+  return buffer;
+}
+
+jsi::Array createShape(jsi::Runtime& runtime, const torch_::Tensor& tensor) {
+  torch_::IntArrayRef dims = tensor.sizes();
+  jsi::Array jsShape = jsi::Array(runtime, dims.size());
+  for (int i = 0; i < dims.size(); i++) {
+    jsShape.setValueAtIndex(runtime, i, jsi::Value((int)dims[i]));
+  }
+  return jsShape;
+}
+
+// A tensor op with parsed arguments. The arguments are parsed on the
+// JavaScript thread, but the op can be computed on any thread, which allows the
+// same op to back a synchronous method and its asynchronous variant.
+template <class TResult>
+struct TensorOp {
+  // Computes the op. The input tensors are not copied, so an async op reads
+  // them while they are still accessible from JavaScript.
+  std::function<TResult()> compute;
+};
+
+jsi::Value createTensor(jsi::Runtime& runtime, torch_::Tensor&& tensor) {
+  return utils::helpers::createFromHostObject<TensorHostObject>(
+      runtime, std::move(tensor));
+}
+
 jsi::Value absImpl(
     jsi::Runtime& runtime,
     const jsi::Value& thisValue,
@@ -251,7 +326,18 @@ jsi::Value dataImpl(
   utils::ArgumentParser args(runtime, thisValue, arguments, count);
   const auto& tensor = args.thisAsHostObject<TensorHostObject>()->tensor;
 
-  int byteLength = tensor.nbytes();
+  // By default, the returned typed array shares memory with the tensor when
+  // the JSI version supports it. Writes through the typed array then change
+  // the tensor. The {copy: true} option always returns an independent copy.
+  auto copyValue = args.keywordValue(0, "copy");
+  bool copy = false;
+  if (copyValue.isBool()) {
+    copy = copyValue.getBool();
+  } else if (!copyValue.isUndefined()) {
+    throw jsi::JSError(
+        runtime, "expect 'copy' to be boolean, but another type is given.");
+  }
+
   auto type = tensor.dtype();
 
   // TODO(T113480543): enable BigInt data view once Hermes support the
@@ -281,13 +367,7 @@ jsi::Value dataImpl(
     throw jsi::JSError(runtime, "tensor data dtype is not supported");
   }
 
-  jsi::ArrayBuffer buffer = runtime.global()
-                                .getPropertyAsFunction(runtime, "ArrayBuffer")
-                                .callAsConstructor(runtime, byteLength)
-                                .asObject(runtime)
-                                .getArrayBuffer(runtime);
-
-  std::memcpy(buffer.data(runtime), tensor.data_ptr(), byteLength);
+  auto buffer = createArrayBuffer(runtime, tensor, copy);
 
   return runtime.global()
       .getPropertyAsFunction(runtime, typedArrayName.c_str())
@@ -295,6 +375,17 @@ jsi::Value dataImpl(
       .asObject(runtime);
 }
 
+jsi::Value disposeImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  utils::ArgumentParser args(runtime, thisValue, arguments, count);
+  args.thisAsHostObject<TensorHostObject>()->dispose();
+  common::detachExternalMemory(runtime, thisValue.asObject(runtime));
+  return jsi::Value::undefined();
+}
+
 jsi::Value divImpl(
     jsi::Runtime& runtime,
     const jsi::Value& thisValue,
@@ -386,7 +477,7 @@ jsi::Value itemImpl(
   }
 }
 
-jsi::Value matmulImpl(
+TensorOp<torch_::Tensor> parseMatmul(
     jsi::Runtime& runtime,
     const jsi::Value& thisValue,
     const jsi::Value* arguments,
@@ -395,8 +486,18 @@ jsi::Value matmulImpl(
   args.requireNumArguments(1);
   auto thisTensor = args.thisAsHostObject<TensorHostObject>()->tensor;
   const auto otherTensor = args.asHostObject<TensorHostObject>(0)->tensor;
-  return utils::helpers::createFromHostObject<TensorHostObject>(
-      runtime, torch_::matmul(thisTensor, otherTensor));
+  return {[thisTensor, otherTensor]() {
+    return torch_::matmul(thisTensor, otherTensor);
+  }};
+}
+
+jsi::Value matmulImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  auto op = parseMatmul(runtime, thisValue, arguments, count);
+  return createTensor(runtime, op.compute());
 }
 
 jsi::Value mulImpl(
@@ -447,7 +548,7 @@ jsi::Value reshapeImpl(
       runtime, std::move(tensor));
 }
 
-jsi::Value softmaxImpl(
+TensorOp<torch_::Tensor> parseSoftmax(
     jsi::Runtime& runtime,
     const jsi::Value& thisValue,
     const jsi::Value* arguments,
@@ -455,9 +556,17 @@ jsi::Value softmaxImpl(
   utils::ArgumentParser args(runtime, thisValue, arguments, count);
   args.requireNumArguments(1);
   auto dim = args.asInteger(0);
-  auto tensor = args.thisAsHostObject<TensorHostObject>()->tensor.softmax(dim);
-  return utils::helpers::createFromHostObject<TensorHostObject>(
-      runtime, std::move(tensor));
+  auto tensor = args.thisAsHostObject<TensorHostObject>()->tensor;
+  return {[tensor, dim]() { return tensor.softmax(dim); }};
+}
+
+jsi::Value softmaxImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  auto op = parseSoftmax(runtime, thisValue, arguments, count);
+  return createTensor(runtime, op.compute());
 };
 
 jsi::Value squeezeImpl(
@@ -541,38 +650,43 @@ jsi::Value subImpl(
       runtime, std::move(tensor));
 }
 
-jsi::Value sumImpl(
+TensorOp<torch_::Tensor> parseSum(
     jsi::Runtime& runtime,
     const jsi::Value& thisValue,
     const jsi::Value* arguments,
     size_t count) {
   utils::ArgumentParser args(runtime, thisValue, arguments, count);
-  auto thiz = args.thisAsHostObject<TensorHostObject>();
+  auto tensor = args.thisAsHostObject<TensorHostObject>()->tensor;
 
-  torch_::Tensor tensor;
   if (count == 0) {
-    tensor = thiz->tensor.sum();
-  } else {
-    size_t nextArgIdx;
-    auto dims = args.dimsVarArgs(0, &nextArgIdx);
-    auto keepdimValue = args.keywordValue(nextArgIdx, "keepdim");
-    if (keepdimValue.isUndefined()) {
-      tensor = thiz->tensor.sum(dims);
-    } else if (keepdimValue.isBool()) {
-      auto keepdim = keepdimValue.getBool();
-      tensor = thiz->tensor.sum(dims, keepdim);
-    } else {
-      throw jsi::JSError(
-          runtime,
-          "expect 'keepdim' to be boolean, but another type is given.");
-    }
+    return {[tensor]() { return tensor.sum(); }};
   }
 
-  return utils::helpers::createFromHostObject<TensorHostObject>(
-      runtime, std::move(tensor));
+  size_t nextArgIdx;
+  auto dims = args.dimsVarArgs(0, &nextArgIdx);
+  auto keepdimValue = args.keywordValue(nextArgIdx, "keepdim");
+  bool keepdim = false;
+  if (keepdimValue.isBool()) {
+    keepdim = keepdimValue.getBool();
+  } else if (!keepdimValue.isUndefined()) {
+    throw jsi::JSError(
+        runtime, "expect 'keepdim' to be boolean, but another type is given.");
+  }
+  return {[tensor, dims, keepdim]() {
+    return tensor.sum(dims, keepdim);
+  }};
+}
+
+jsi::Value sumImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  auto op = parseSum(runtime, thisValue, arguments, count);
+  return createTensor(runtime, op.compute());
 };
 
-jsi::Value toImpl(
+TensorOp<torch_::Tensor> parseTo(
     jsi::Runtime& runtime,
     const jsi::Value& thisValue,
     const jsi::Value* arguments,
@@ -580,13 +694,24 @@ jsi::Value toImpl(
   utils::ArgumentParser args(runtime, thisValue, arguments, count);
   args.requireNumArguments(1);
   auto tensorOptions = args.tensorOptions(0);
-  auto tensor =
-      args.thisAsHostObject<TensorHostObject>()->tensor.to(tensorOptions);
-  return utils::helpers::createFromHostObject<TensorHostObject>(
-      runtime, std::move(tensor));
+  auto tensor = args.thisAsHostObject<TensorHostObject>()->tensor;
+  return {[tensor, tensorOptions]() {
+    return tensor.to(tensorOptions);
+  }};
+}
+
+jsi::Value toImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  auto op = parseTo(runtime, thisValue, arguments, count);
+  return createTensor(runtime, op.compute());
 };
 
-jsi::Value topkImpl(
+using TopkResult = std::tuple<torch_::Tensor, torch_::Tensor>;
+
+TensorOp<TopkResult> parseTopk(
     jsi::Runtime& runtime,
     const jsi::Value& thisValue,
     const jsi::Value* arguments,
@@ -620,21 +745,55 @@ jsi::Value topkImpl(
         runtime, "expect 'sorted' to be boolean, but another type is given.");
   }
 
-  auto resultTuple = args.thisAsHostObject<TensorHostObject>()->tensor.topk(
-      k, dim, largest, sorted);
-  auto values = utils::helpers::createFromHostObject<TensorHostObject>(
-      runtime, std::get<0>(resultTuple));
-  /**
-   * NOTE: We need to convert the int64 type to int32 since Hermes does not
-   * support Int64 data types yet.
-   */
-  auto indicesInt64Tensor = std::get<1>(resultTuple);
-  auto indices = utils::helpers::createFromHostObject<TensorHostObject>(
-      runtime, indicesInt64Tensor.to(c10::ScalarType::Int));
+  auto tensor = args.thisAsHostObject<TensorHostObject>()->tensor;
+  return {[tensor, k, dim, largest, sorted]() {
+    auto resultTuple = tensor.topk(k, dim, largest, sorted);
+    /**
+     * NOTE: We need to convert the int64 type to int32 since Hermes
+     * does not support Int64 data types yet.
+     */
+    return std::make_tuple(
+        std::get<0>(resultTuple),
+        std::get<1>(resultTuple).to(c10::ScalarType::Int));
+  }};
+}
 
+jsi::Value createTopkResult(jsi::Runtime& runtime, TopkResult&& result) {
+  auto values = createTensor(runtime, std::move(std::get<0>(result)));
+  auto indices = createTensor(runtime, std::move(std::get<1>(result)));
   return jsi::Array::createWithElements(runtime, values, indices);
+}
+
+jsi::Value topkImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  auto op = parseTopk(runtime, thisValue, arguments, count);
+  return createTopkResult(runtime, op.compute());
 };
 
+jsi::Value sizeImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  utils::ArgumentParser args(runtime, thisValue, arguments, count);
+  const auto& tensor = args.thisAsHostObject<TensorHostObject>()->tensor;
+  return createShape(runtime, tensor);
+}
+
+jsi::Value toStringImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  utils::ArgumentParser args(runtime, thisValue, arguments, count);
+  std::ostringstream stream;
+  stream << args.thisAsHostObject<TensorHostObject>()->tensor;
+  return jsi::String::createFromUtf8(runtime, stream.str());
+}
+
 jsi::Value unsqueezeImpl(
     jsi::Runtime& runtime,
     const jsi::Value& thisValue,
@@ -651,40 +810,169 @@ jsi::Value unsqueezeImpl(
       runtime, std::move(tensor));
 }
 
+template <class TResult>
+using TensorOpAsyncTask = common::AsyncTask<TensorOp<TResult>, TResult>;
+
+// Calls the async variant of an op. The op is computed on a worker thread and
+// the returned Promise resolves with the result, which is always a new tensor
+// or, for ops returning views, shares the storage with an input tensor like the
+// sync op does.
+//
+// The input tensors are not copied, because copying them would cost about as
+// much as many of the ops. They must not be modified until the Promise
+// settles, neither in place (e.g., tensor[0] = 1) nor through an ArrayBuffer
+// returned by tensor.data(). Modifications are not detected.
+template <class TResult>
+jsi::Value callAsync(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count,
+    TensorOp<TResult> (*parseFunc)(
+        jsi::Runtime&,
+        const jsi::Value&,
+        const jsi::Value*,
+        size_t),
+    jsi::Value (*resolveFunc)(jsi::Runtime&, TResult&&)) {
+  using Task = TensorOpAsyncTask<TResult>;
+  auto promiseFunc = Task::createPromiseFunction(
+      getRuntimeExecutor(runtime),
+      [parseFunc](
+          jsi::Runtime& runtime,
+          const jsi::Value& thisValue,
+          const jsi::Value* arguments,
+          size_t count) -> typename Task::SetupResultType {
+        return parseFunc(runtime, thisValue, arguments, count);
+      },
+      [](typename Task::SetupResultType&& op) -> TResult {
+        // Ops split their work across the intra-op threads, which must not
+        // be resized while they run.
+        jit::mobile::IntraOpThreadsCall threadsCall;
+        return op.compute();
+      },
+      [resolveFunc](
+          jsi::Runtime& runtime,
+          torchlive::RuntimeExecutor,
+          TResult&& result) -> jsi::Value {
+        return resolveFunc(runtime, std::move(result));
+      });
+  return promiseFunc(runtime, thisValue, arguments, count);
+}
+
+jsi::Value matmulAsyncImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  return callAsync<torch_::Tensor>(
+      runtime, thisValue, arguments, count, parseMatmul, createTensor);
+}
+
+jsi::Value softmaxAsyncImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  return callAsync<torch_::Tensor>(
+      runtime, thisValue, arguments, count, parseSoftmax, createTensor);
+}
+
+jsi::Value sumAsyncImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  return callAsync<torch_::Tensor>(
+      runtime, thisValue, arguments, count, parseSum, createTensor);
+}
+
+jsi::Value toAsyncImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  return callAsync<torch_::Tensor>(
+      runtime, thisValue, arguments, count, parseTo, createTensor);
+}
+
+jsi::Value topkAsyncImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  return callAsync<TopkResult>(
+      runtime, thisValue, arguments, count, parseTopk, createTopkResult);
+}
+
 } // namespace
 
+// TensorHostObject Methods
+static const common::BaseHostObject::SharedMethods METHODS = {
+    {"abs", 0, absImpl},
+    {"add", 1, addImpl},
+    {"argmax", 0, argmaxImpl},
+    {"argmin", 0, argminImpl},
+    {"expand", 1, expandImpl},
+    {"clamp", 1, clampImp},
+    {"contiguous", 0, contiguousImpl},
+    {"data", 0, dataImpl},
+    {"dispose", 0, disposeImpl},
+    {"div", 1, divImpl},
+    {"flip", 1, flipImpl},
+    {"item", 0, itemImpl},
+    {"matmul", 1, matmulImpl},
+    {"matmulAsync", 1, matmulAsyncImpl},
+    {"mul", 1, mulImpl},
+    {"permute", 1, permuteImpl},
+    {"reshape", 1, reshapeImpl},
+    {"size", 0, sizeImpl},
+    {"softmax", 1, softmaxImpl},
+    {"softmaxAsync", 1, softmaxAsyncImpl},
+    {"squeeze", 1, squeezeImpl},
+    {"sqrt", 0, sqrtImpl},
+    {"stride", 0, strideImpl},
+    {"sub", 1, subImpl},
+    {"sum", 0, sumImpl},
+    {"sumAsync", 0, sumAsyncImpl},
+    {"to", 1, toImpl},
+    {"toAsync", 1, toAsyncImpl},
+    {"toString", 0, toStringImpl},
+    {"topk", 1, topkImpl},
+    {"topkAsync", 1, topkAsyncImpl},
+    {"unsqueeze", 1, unsqueezeImpl},
+};
+
 TensorHostObject::TensorHostObject(jsi::Runtime& runtime, torch_::Tensor t)
-    : BaseHostObject(runtime),
-      size_(createSize(runtime)),
-      toString_(createToString(runtime)),
-      tensor(t) {
-  setPropertyHostFunction(runtime, "abs", 0, absImpl);
-  setPropertyHostFunction(runtime, "add", 1, addImpl);
-  setPropertyHostFunction(runtime, "argmax", 0, argmaxImpl);
-  setPropertyHostFunction(runtime, "argmin", 0, argminImpl);
-  setPropertyHostFunction(runtime, "expand", 1, expandImpl);
-  setPropertyHostFunction(runtime, "clamp", 1, clampImp);
-  setPropertyHostFunction(runtime, "contiguous", 0, contiguousImpl);
-  setPropertyHostFunction(runtime, "data", 0, dataImpl);
-  setPropertyHostFunction(runtime, "div", 1, divImpl);
-  setPropertyHostFunction(runtime, "flip", 1, flipImpl);
-  setPropertyHostFunction(runtime, "item", 0, itemImpl);
-  setPropertyHostFunction(runtime, "matmul", 1, matmulImpl);
-  setPropertyHostFunction(runtime, "mul", 1, mulImpl);
-  setPropertyHostFunction(runtime, "permute", 1, permuteImpl);
-  setPropertyHostFunction(runtime, "reshape", 1, reshapeImpl);
-  setPropertyHostFunction(runtime, "softmax", 1, softmaxImpl);
-  setPropertyHostFunction(runtime, "squeeze", 1, squeezeImpl);
-  setPropertyHostFunction(runtime, "sqrt", 0, sqrtImpl);
-  setPropertyHostFunction(runtime, "stride", 0, strideImpl);
-  setPropertyHostFunction(runtime, "sub", 1, subImpl);
-  setPropertyHostFunction(runtime, "sum", 0, sumImpl);
-  setPropertyHostFunction(runtime, "to", 1, toImpl);
-  setPropertyHostFunction(runtime, "topk", 1, topkImpl);
-  setPropertyHostFunction(runtime, "unsqueeze", 1, unsqueezeImpl);
-}
-
-TensorHostObject::~TensorHostObject() {}
+    : BaseHostObject(runtime), tensor(t) {
+  setSharedMethods(runtime, METHODS, PROPERTIES);
+  TensorScope::track(this);
+}
+
+TensorHostObject::~TensorHostObject() {
+  TensorScope::untrack(this);
+  if (!disposed_) {
+    TensorScope::countFree();
+  }
+}
+
+common::ExternalMemory TensorHostObject::getExternalMemory() const {
+  if (disposed_ || !tensor.defined() || !tensor.has_storage()) {
+    return {nullptr, 0};
+  }
+  // Views of a tensor and tensors created from a blob point into memory that
+  // is reported by the other host object.
+  const auto& storage = tensor.storage();
+  return {storage.data(), storage.nbytes()};
+}
+
+void TensorHostObject::dispose() {
+  if (!disposed_) {
+    disposed_ = true;
+    tensor = torch_::Tensor();
+    releaseExternalMemory();
+    TensorScope::countFree();
+  }
+}
 
 std::vector<jsi::PropNameID> TensorHostObject::getPropertyNames(
     jsi::Runtime& runtime) {
@@ -692,67 +980,69 @@ std::vector<jsi::PropNameID> TensorHostObject::getPropertyNames(
   for (std::string property : PROPERTIES) {
     result.push_back(jsi::PropNameID::forUtf8(runtime, property));
   }
-  for (std::string method : METHODS) {
-    result.push_back(jsi::PropNameID::forUtf8(runtime, method));
-  }
   return result;
 }
 
 jsi::Value TensorHostObject::get(
     jsi::Runtime& runtime,
     const jsi::PropNameID& propNameId) {
+  // The computed properties and the methods are resolved by comparing the
+  // interned property names, which avoids converting the name to UTF-8 for the
+  // most frequent accesses.
+  if (disposed_ && propNameId.utf8(runtime) != DISPOSE) {
+    throw jsi::JSError(runtime, "Tensor is disposed");
+  }
+  if (auto property = findSharedProperty(runtime, propNameId)) {
+    if (*property == DTYPE) {
+      return jsi::String::createFromUtf8(
+          runtime,
+          utils::constants::getStringFromDtype(
+              caffe2::typeMetaToScalarType(this->tensor.dtype())));
+    } else if (*property == SHAPE) {
+      return createShape(runtime, this->tensor);
+    }
+  }
+  auto method = getSharedMethod(runtime, propNameId);
+  if (!method.isUndefined()) {
+    return method;
+  }
+
+  // Only index accesses and unknown names are converted to UTF-8.
   auto name = propNameId.utf8(runtime);
 
-  if (name == DTYPE) {
-    return jsi::String::createFromUtf8(
-        runtime,
-        utils::constants::getStringFromDtype(
-            caffe2::typeMetaToScalarType(this->tensor.dtype())));
-  } else if (name == SHAPE) {
-    return this->size_.call(runtime);
-  } else if (name == SIZE) {
-    return jsi::Value(runtime, size_);
-  } else if (name == TOSTRING) {
-    return jsi::Value(runtime, toString_);
-  }
-
-  int idx = -1;
-  try {
-    idx = std::stoi(name.c_str());
-  } catch (...) {
-    // Cannot parse name value to int. This can happen when the name in bracket
-    // or dot notion is not an int (e.g., tensor['foo']).
-    // Let's ignore this exception here since this function will return
-    // undefined if it reaches the function end.
-  }
-  // Check if index is within bounds of dimension 0
-  if (idx >= 0 && idx < this->tensor.size(0)) {
+  // Check if index is within bounds of dimension 0. A name that isn't an index
+  // (e.g., tensor['foo']) falls through and returns undefined.
+  int64_t idx;
+  if (parseIndex(name, &idx) && this->tensor.dim() > 0 &&
+      idx < this->tensor.size(0)) {
     auto outputTensor = this->tensor.index({idx});
-    auto tensorHostObject =
-        std::make_shared<torchlive::torch::TensorHostObject>(
-            runtime, std::move(outputTensor));
-    return jsi::Object::createFromHostObject(runtime, tensorHostObject);
+    return utils::helpers::createFromHostObject<TensorHostObject>(
+        runtime, std::move(outputTensor));
   }
 
-  return BaseHostObject::get(runtime, propNameId);
+  return BaseHostObject::get(runtime, propNameId, name);
 }
 
 void TensorHostObject::set(
     jsi::Runtime& runtime,
     const jsi::PropNameID& propNameId,
     const jsi::Value& value) {
+  if (disposed_) {
+    throw jsi::JSError(runtime, "Tensor is disposed");
+  }
   auto name = propNameId.utf8(runtime);
 
-  int idx = -1;
-  try {
-    idx = std::stoi(name.c_str());
-  } catch (...) {
-    // Cannot parse name value to int. This can happen when the name in bracket
-    // or dot notion is not an int (e.g., tensor['foo']).
-    // Let's ignore this exception here and have the PyTorch C++ API throw an
-    // error for index out of bounds.
-    // Note: The Tensor Indexing API allows for a much broader range of indices
-    // but for now, the PlayTorch API only supports single value index values.
+  // Note: The Tensor Indexing API allows for a much broader range of indices
+  // but for now, the PlayTorch API only supports single value index values.
+  // Negative indices count from the end of dimension 0. Out of bounds indices
+  // are reported by the PyTorch C++ API.
+  int64_t idx;
+  bool negative = !name.empty() && name[0] == '-';
+  if (!parseIndex(negative ? name.substr(1) : name, &idx)) {
+    throw jsi::JSError(runtime, "Invalid index! The index has to be an integer");
+  }
+  if (negative) {
+    idx = -idx;
   }
   if (value.isObject()) {
     // Get TensorHostObject with wrapped tensor, otherwise it will be nullptr
@@ -770,39 +1060,5 @@ void TensorHostObject::set(
   }
 }
 
-jsi::Function TensorHostObject::createToString(jsi::Runtime& runtime) {
-  auto toStringFunc = [this](
-                          jsi::Runtime& runtime,
-                          const jsi::Value& thisValue,
-                          const jsi::Value* arguments,
-                          size_t count) -> jsi::Value {
-    std::ostringstream stream;
-    stream << this->tensor;
-    std::string tensor_string = stream.str();
-    auto val = jsi::String::createFromUtf8(runtime, tensor_string);
-    return jsi::Value(std::move(val));
-  };
-  return jsi::Function::createFromHostFunction(
-      runtime, jsi::PropNameID::forUtf8(runtime, TOSTRING), 0, toStringFunc);
-}
-
-jsi::Function TensorHostObject::createSize(jsi::Runtime& runtime) {
-  auto sizeFunc = [this](
-                      jsi::Runtime& runtime,
-                      const jsi::Value& thisValue,
-                      const jsi::Value* arguments,
-                      size_t count) -> jsi::Value {
-    torch_::IntArrayRef dims = this->tensor.sizes();
-    jsi::Array jsShape = jsi::Array(runtime, dims.size());
-    for (int i = 0; i < dims.size(); i++) {
-      jsShape.setValueAtIndex(runtime, i, jsi::Value((int)dims[i]));
-    }
-
-    return jsShape;
-  };
-  return jsi::Function::createFromHostFunction(
-      runtime, jsi::PropNameID::forUtf8(runtime, SIZE), 0, sizeFunc);
-}
-
 } // namespace torch
 } // namespace torchlive
@@ -28,9 +28,6 @@ namespace torchlive {
 namespace torch {
 
 class JSI_EXPORT TensorHostObject : public common::BaseHostObject {
-  facebook::jsi::Function size_;
-  facebook::jsi::Function toString_;
-
  public:
   explicit TensorHostObject(facebook::jsi::Runtime& runtime, torch_::Tensor t);
   ~TensorHostObject();
@@ -45,11 +42,20 @@ class JSI_EXPORT TensorHostObject : public common::BaseHostObject {
   std::vector<facebook::jsi::PropNameID> getPropertyNames(
       facebook::jsi::Runtime& rt) override;
 
+  // Releases the tensor before the host object is garbage collected. The
+  // properties and methods of a disposed tensor throw, except for dispose.
+  void dispose();
+
+  bool isDisposed() const {
+    return disposed_;
+  }
+
+  common::ExternalMemory getExternalMemory() const override;
+
   torch_::Tensor tensor;
 
  private:
-  facebook::jsi::Function createSize(facebook::jsi::Runtime& runtime);
-  facebook::jsi::Function createToString(facebook::jsi::Runtime& runtime);
+  bool disposed_ = false;
 };
 
 } // namespace torch
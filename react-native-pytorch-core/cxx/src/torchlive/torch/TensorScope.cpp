@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <atomic>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include "TensorHostObject.h"
+#include "TensorScope.h"
+
+namespace torchlive {
+namespace torch {
+
+namespace {
+
+std::atomic<std::size_t> allocatedTensors(0);
+std::atomic<std::size_t> freedTensors(0);
+
+// Host objects can be destroyed on other threads than the JavaScript thread,
+// e.g., when a task that holds one completes, so the scopes are locked.
+std::mutex scopesMutex;
+std::vector<std::unordered_set<TensorHostObject*>> scopes;
+
+} // namespace
+
+TensorScope::TensorScope() {
+  std::lock_guard<std::mutex> lock(scopesMutex);
+  depth_ = scopes.size();
+  scopes.emplace_back();
+}
+
+TensorScope::~TensorScope() {
+  std::lock_guard<std::mutex> lock(scopesMutex);
+  // The tensors are disposed while the lock is held, so none of their host
+  // objects can be destroyed in the meantime.
+  for (auto tensor : scopes.back()) {
+    tensor->dispose();
+  }
+  scopes.pop_back();
+}
+
+void TensorScope::escape(TensorHostObject* tensor) {
+  std::lock_guard<std::mutex> lock(scopesMutex);
+  if (scopes[depth_].erase(tensor) > 0 && depth_ > 0) {
+    scopes[depth_ - 1].insert(tensor);
+  }
+}
+
+void TensorScope::keep(TensorHostObject* tensor) {
+  std::lock_guard<std::mutex> lock(scopesMutex);
+  for (auto& scope : scopes) {
+    scope.erase(tensor);
+  }
+}
+
+TensorScope::Stats TensorScope::stats() {
+  return {allocatedTensors.load(), freedTensors.load()};
+}
+
+void TensorScope::track(TensorHostObject* tensor) {
+  allocatedTensors++;
+  std::lock_guard<std::mutex> lock(scopesMutex);
+  if (!scopes.empty()) {
+    scopes.back().insert(tensor);
+  }
+}
+
+void TensorScope::untrack(TensorHostObject* tensor) {
+  std::lock_guard<std::mutex> lock(scopesMutex);
+  for (auto& scope : scopes) {
+    scope.erase(tensor);
+  }
+}
+
+void TensorScope::countFree() {
+  freedTensors++;
+}
+
+} // namespace torch
+} // namespace torchlive
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace torchlive {
+namespace torch {
+
+class TensorHostObject;
+
+// Tracks the TensorHostObjects created while the scope is open, and disposes
+// their tensors when the scope closes, unless they escaped the scope or were
+// kept. Scopes nest, and are opened and closed on the JavaScript thread.
+class TensorScope {
+ public:
+  // Counts of tensors wrapped in and released by TensorHostObjects. A tensor
+  // is released when it is disposed or when its host object is destroyed.
+  struct Stats {
+    std::size_t allocated;
+    std::size_t freed;
+  };
+
+  TensorScope();
+  // Disposes the tensors that are still tracked by the scope.
+  ~TensorScope();
+
+  TensorScope(const TensorScope&) = delete;
+  TensorScope& operator=(const TensorScope&) = delete;
+
+  // Moves the tensor to the enclosing scope, or stops tracking it if this is
+  // the outermost scope, e.g., for tensors returned from the scope.
+  void escape(TensorHostObject* tensor);
+
+  // Stops tracking the tensor in all open scopes.
+  static void keep(TensorHostObject* tensor);
+
+  static Stats stats();
+
+  // Called by TensorHostObject when it is created and destroyed, and when it
+  // releases its tensor.
+  static void track(TensorHostObject* tensor);
+  static void untrack(TensorHostObject* tensor);
+  static void countFree();
+
+ private:
+  std::size_t depth_;
+};
+
+} // namespace torch
+} // namespace torchlive
@@ -7,14 +7,18 @@
 
 #include <jsi/jsi.h>
 
+#include <cmath>
+#include <limits>
 #include <memory>
 #include <vector>
 
 #include "../media/BlobHostObject.h"
 #include "../torchlive.h"
 #include "TensorHostObject.h"
+#include "TensorScope.h"
 #include "TorchNamespace.h"
 #include "jit/JITNamespace.h"
+#include "jit/mobile/IntraOpThreads.h"
 #include "jsi/jsi.h"
 #include "utils/ArgumentParser.h"
 #include "utils/constants.h"
@@ -52,6 +56,38 @@ static const std::map<std::string, std::string> CONSTANTS = {
 
 namespace {
 
+// How deep arrays and objects returned from a scope are searched for tensors.
+const int kMaxEscapeDepth = 8;
+
+// Moves the tensors of a value returned from a scope to the enclosing scope.
+// Arrays and plain objects are searched for tensors as well.
+void escapeTensors(
+    jsi::Runtime& runtime,
+    TensorScope& scope,
+    const jsi::Value& value,
+    int depth) {
+  if (!value.isObject() || depth > kMaxEscapeDepth) {
+    return;
+  }
+  auto object = value.getObject(runtime);
+  if (object.isHostObject<TensorHostObject>(runtime)) {
+    scope.escape(object.getHostObject<TensorHostObject>(runtime).get());
+  } else if (object.isArray(runtime)) {
+    auto array = object.getArray(runtime);
+    for (size_t i = 0; i < array.size(runtime); i++) {
+      escapeTensors(
+          runtime, scope, array.getValueAtIndex(runtime, i), depth + 1);
+    }
+  } else if (!object.isHostObject(runtime) && !object.isFunction(runtime)) {
+    auto names = object.getPropertyNames(runtime);
+    for (size_t i = 0; i < names.size(runtime); i++) {
+      auto name = names.getValueAtIndex(runtime, i).getString(runtime);
+      escapeTensors(
+          runtime, scope, object.getProperty(runtime, name), depth + 1);
+    }
+  }
+}
+
 jsi::Value arangeImpl(
     jsi::Runtime& runtime,
     const jsi::Value& thisValue,
@@ -165,8 +201,18 @@ jsi::Value fromBlobImpl(
   std::vector<int64_t> sizes;
   sizes.reserve(sizesLength);
   for (int i = 0; i < sizesLength; i++) {
-    auto value = jsSizes.getValueAtIndex(runtime, i);
-    sizes.push_back(value.asNumber());
+    auto value = jsSizes.getValueAtIndex(runtime, i).asNumber();
+    if (!std::isfinite(value) || std::fmod(value, 1) != 0) {
+      throw jsi::JSError(runtime, "sizes must be integers");
+    }
+    if (value < 0) {
+      throw jsi::JSError(runtime, "sizes must be non-negative");
+    }
+    // Converting a larger double to int64_t is undefined.
+    if (value >= static_cast<double>(std::numeric_limits<int64_t>::max())) {
+      throw jsi::JSError(runtime, "the tensor of sizes is too large");
+    }
+    sizes.push_back(value);
   }
 
   const auto& blobHostObject =
@@ -174,14 +220,45 @@ jsi::Value fromBlobImpl(
   auto tensorOptions =
       utils::helpers::parseTensorOptions(runtime, arguments, 2, count);
   auto blob = blobHostObject->blob.get();
-  uint8_t* const buffer = blob->getDirectBytes();
   if (!tensorOptions.has_dtype()) {
     // explicitly set to default uint8 dtype
     tensorOptions = torch_::TensorOptions().dtype(torch_::kUInt8);
   }
-  // TODO(T111718110) Check if blob sizes exceed buffer size and if so throw
-  // an error
-  auto tensor = torch_::from_blob(buffer, sizes, tensorOptions).clone();
+
+  // The multiplications are checked, because sizes that overflow the byte
+  // count would pass the size check below and read past the blob data.
+  auto itemSize = tensorOptions.dtype().itemsize();
+  size_t numel = 1;
+  for (auto size : sizes) {
+    if (size != 0 &&
+        numel > std::numeric_limits<size_t>::max() /
+                static_cast<size_t>(size)) {
+      throw jsi::JSError(runtime, "the tensor of sizes is too large");
+    }
+    numel *= size;
+  }
+  if (numel > std::numeric_limits<size_t>::max() / itemSize) {
+    throw jsi::JSError(runtime, "the tensor of sizes is too large");
+  }
+  if (numel * itemSize > blob->getDirectSize()) {
+    throw jsi::JSError(
+        runtime,
+        "the tensor of sizes requires " + std::to_string(numel * itemSize) +
+            " bytes, but the blob has only " +
+            std::to_string(blob->getDirectSize()) + " bytes");
+  }
+
+  // The tensor aliases the blob data and holds a reference to it, so the data
+  // stays alive as long as the tensor, even if the blob is garbage collected.
+  // Data that is not aligned to the dtype (e.g., a sliced blob) is copied.
+  auto data = blob->getSharedBytes();
+  torch_::Tensor tensor;
+  if (reinterpret_cast<uintptr_t>(data.get()) % itemSize == 0) {
+    tensor = torch_::from_blob(
+        data.get(), sizes, [data](void*) {}, tensorOptions);
+  } else {
+    tensor = torch_::from_blob(data.get(), sizes, tensorOptions).clone();
+  }
   return utils::helpers::createFromHostObject<TensorHostObject>(
       runtime, std::move(tensor));
 }
@@ -211,6 +288,40 @@ jsi::Value fullImpl(
       runtime, torch_::full(dims, fillValue, options));
 }
 
+jsi::Value getNumThreadsImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  return static_cast<double>(jit::mobile::defaultIntraOpThreads());
+}
+
+jsi::Value getTensorStatsImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  auto stats = TensorScope::stats();
+  jsi::Object result(runtime);
+  result.setProperty(
+      runtime, "allocated", static_cast<double>(stats.allocated));
+  result.setProperty(runtime, "freed", static_cast<double>(stats.freed));
+  result.setProperty(
+      runtime, "live", static_cast<double>(stats.allocated - stats.freed));
+  return result;
+}
+
+jsi::Value keepImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  auto args = utils::ArgumentParser(runtime, thisValue, arguments, count);
+  args.requireNumArguments(1);
+  TensorScope::keep(utils::helpers::parseTensor(runtime, &args[0]));
+  return jsi::Value(runtime, args[0]);
+}
+
 jsi::Value linspaceImpl(
     jsi::Runtime& runtime,
     const jsi::Value& thisValue,
@@ -365,6 +476,40 @@ jsi::Value randnImpl(
       runtime, torch_::randn(dims, options));
 }
 
+jsi::Value scopeImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  auto args = utils::ArgumentParser(runtime, thisValue, arguments, count);
+  args.requireNumArguments(1);
+  if (!args[0].isObject() || !args[0].asObject(runtime).isFunction(runtime)) {
+    throw jsi::JSError(runtime, "expect scope callback to be a function");
+  }
+  auto callback = args[0].asObject(runtime).asFunction(runtime);
+  // The scope disposes its tensors when it closes, also when the callback
+  // throws.
+  TensorScope scope;
+  auto result = callback.call(runtime);
+  escapeTensors(runtime, scope, result, 0);
+  return result;
+}
+
+jsi::Value setNumThreadsImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  auto args = utils::ArgumentParser(runtime, thisValue, arguments, count);
+  args.requireNumArguments(1);
+  auto threads = args[0].asNumber();
+  if (threads < 0 || threads != static_cast<size_t>(threads)) {
+    throw jsi::JSError(runtime, "expect threads to be a non-negative integer");
+  }
+  jit::mobile::setDefaultIntraOpThreads(static_cast<size_t>(threads));
+  return jsi::Value::undefined();
+}
+
 jsi::Value tensorImpl(
     jsi::Runtime& runtime,
     const jsi::Value& thisValue,
@@ -373,6 +518,27 @@ jsi::Value tensorImpl(
   auto args = utils::ArgumentParser(runtime, thisValue, arguments, count);
   args.requireNumArguments(1);
 
+  // Fast path for TypedArray and ArrayBuffer data, which is copied in bulk
+  // into a tensor of the matching dtype. The shape defaults to the
+  // one-dimensional length of the data.
+  auto typedArrayTensor = utils::helpers::parseTypedArray(runtime, args[0]);
+  if (typedArrayTensor.defined()) {
+    auto dtypeValue = args.keywordValue(1, "dtype");
+    if (!dtypeValue.isUndefined()) {
+      typedArrayTensor =
+          typedArrayTensor.to(utils::constants::getDtypeFromString(
+              dtypeValue.asString(runtime).utf8(runtime)));
+    }
+    auto shapeValue = args.keywordValue(1, "shape");
+    if (!shapeValue.isUndefined()) {
+      std::vector<int64_t> shape = {};
+      utils::helpers::parseSize(runtime, &shapeValue, 0, 1, &shape);
+      typedArrayTensor = typedArrayTensor.reshape(shape);
+    }
+    return utils::helpers::createFromHostObject<TensorHostObject>(
+        runtime, std::move(typedArrayTensor));
+  }
+
   std::vector<double> data =
       utils::helpers::parseJSIArrayData(runtime, arguments[0]);
   std::vector<int64_t> shape =
@@ -427,6 +593,9 @@ jsi::Object buildNamespace(jsi::Runtime& rt, RuntimeExecutor rte) {
   setPropertyHostFunction(rt, ns, "eye", 1, eyeImpl);
   setPropertyHostFunction(rt, ns, "fromBlob", 2, fromBlobImpl);
   setPropertyHostFunction(rt, ns, "full", 2, fullImpl);
+  setPropertyHostFunction(rt, ns, "getNumThreads", 0, getNumThreadsImpl);
+  setPropertyHostFunction(rt, ns, "getTensorStats", 0, getTensorStatsImpl);
+  setPropertyHostFunction(rt, ns, "keep", 1, keepImpl);
   setPropertyHostFunction(rt, ns, "linspace", 3, linspaceImpl);
   setPropertyHostFunction(rt, ns, "logspace", 3, logspaceImpl);
   setPropertyHostFunction(rt, ns, "ones", 1, onesImpl);
@@ -434,6 +603,8 @@ jsi::Object buildNamespace(jsi::Runtime& rt, RuntimeExecutor rte) {
   setPropertyHostFunction(rt, ns, "randint", 2, randintImpl);
   setPropertyHostFunction(rt, ns, "randn", 1, randnImpl);
   setPropertyHostFunction(rt, ns, "randperm", 1, randpermImpl);
+  setPropertyHostFunction(rt, ns, "scope", 1, scopeImpl);
+  setPropertyHostFunction(rt, ns, "setNumThreads", 1, setNumThreadsImpl);
   setPropertyHostFunction(rt, ns, "tensor", 1, tensorImpl);
   setPropertyHostFunction(rt, ns, "zeros", 1, zerosImpl);
   return ns;
@@ -15,11 +15,24 @@
 #include <torch/script.h>
 #pragma clang diagnostic pop
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
 #include "../../common/AsyncTask.h"
+#include "../../filesystem/FilesystemNamespace.h"
+#include "../../media/BlobHostObject.h"
 #include "../../torch/utils/ArgumentParser.h"
 #include "../../torch/utils/helpers.h"
 #include "JITNamespace.h"
+#include "mobile/IntraOpThreads.h"
+#include "mobile/ModelLoader.h"
+#include "mobile/ModelRegistry.h"
+#include "mobile/ModelWarmup.h"
 #include "mobile/ModuleHostObject.h"
+#include "mobile/ModulePool.h"
 
 // Namespace alias for torch to avoid namespace conflicts with torchlive::torch
 namespace torch_ = torch;
@@ -34,16 +47,200 @@ namespace {
 
 using ExtraFilesMap = std::unordered_map<std::string, std::string>;
 
+// The model to load, either a file path or the model bytes in memory.
+struct ModelSource {
+  std::string path;
+  std::shared_ptr<char> data;
+  size_t size = 0;
+};
+
+// Returns the bytes of a blob, an ArrayBuffer, or a view of an ArrayBuffer
+// like a Uint8Array, without copying them. The returned pointer keeps the
+// bytes alive. For ArrayBuffers, it holds a reference to the JavaScript
+// object, which is released on the JavaScript thread.
+ModelSource parseModelBytes(jsi::Runtime& runtime, const jsi::Value& value) {
+  auto obj = value.asObject(runtime);
+  ModelSource source;
+  if (obj.isHostObject<media::BlobHostObject>(runtime)) {
+    const auto& blob = obj.getHostObject<media::BlobHostObject>(runtime)->blob;
+    // Alias the blob data, so the model bytes outlive the blob host object.
+    auto bytes = blob->getSharedBytes();
+    source.data = std::shared_ptr<char>(
+        bytes, reinterpret_cast<char*>(blob->getDirectBytes()));
+    source.size = blob->getDirectSize();
+    return source;
+  }
+
+  size_t byteOffset = 0;
+  size_t byteLength = 0;
+  jsi::Object bufferObject = std::move(obj);
+  if (!bufferObject.isArrayBuffer(runtime)) {
+    auto bufferValue = bufferObject.getProperty(runtime, "buffer");
+    if (!bufferValue.isObject() ||
+        !bufferValue.asObject(runtime).isArrayBuffer(runtime)) {
+      throw jsi::JSError(
+          runtime,
+          "expect a file path, a Blob, an ArrayBuffer, or a typed array");
+    }
+    // The object isn't necessarily a typed array, so its range is checked
+    // against the size of the buffer.
+    auto parseIndex = [&](const char* name) {
+      auto value = bufferObject.getProperty(runtime, name);
+      double number = value.isNumber() ? value.asNumber() : -1;
+      if (!std::isfinite(number) || number < 0 || std::fmod(number, 1) != 0) {
+        throw jsi::JSError(
+            runtime, std::string(name) + " must be a non-negative integer");
+      }
+      return number;
+    };
+    double offset = parseIndex("byteOffset");
+    double length = parseIndex("byteLength");
+    bufferObject = bufferValue.asObject(runtime);
+    if (offset + length > bufferObject.getArrayBuffer(runtime).size(runtime)) {
+      throw jsi::JSError(
+          runtime, "the model bytes exceed the size of their buffer");
+    }
+    byteOffset = static_cast<size_t>(offset);
+    byteLength = static_cast<size_t>(length);
+  } else {
+    byteLength = bufferObject.getArrayBuffer(runtime).size(runtime);
+  }
+
+  auto buffer = bufferObject.getArrayBuffer(runtime);
+  auto data = reinterpret_cast<char*>(buffer.data(runtime)) + byteOffset;
+  auto anchor = std::make_shared<jsi::Value>(std::move(bufferObject));
+  auto runtimeExecutor = torchlive::getRuntimeExecutor(runtime);
+  // The model may be released on a worker thread, e.g., when a loader aliases
+  // the bytes, but the jsi::Value must be released on the JavaScript thread.
+  source.data = std::shared_ptr<char>(
+      data, [runtimeExecutor, anchor](char*) mutable {
+        runtimeExecutor(
+            [anchor = std::move(anchor)](jsi::Runtime&) mutable {
+              anchor.reset();
+            });
+      });
+  source.size = byteLength;
+  return source;
+}
+
+// The options of _loadForMobile.
+struct LoadOptions {
+  bool mmap = false;
+  bool warmup = false;
+  // Without shapes, the shapes are read from the kWarmupExtraFile of the model.
+  // Thread autotuning uses the same inputs.
+  mobile::WarmupSpec warmupSpec;
+  // The intra-op thread count of the model, or 0 for the default.
+  std::size_t threads = 0;
+  bool autotune = false;
+  // The highest thread count to try, or 0 for the number of cores.
+  std::size_t autotuneMaxThreads = 0;
+  // The file that stores tuned thread counts. Defaults to kTuningCacheFile in
+  // the cache directory of the app, see filesystem::getCacheDirectory.
+  std::string autotuneCachePath;
+};
+
+constexpr const char* kTuningCacheFile = "torchlive.threads";
+
+// The time it took to load the model, to tune its thread count and to warm it
+// up, and the thread count of the model.
+struct LoadStats {
+  std::chrono::microseconds load;
+  std::chrono::microseconds autotune;
+  std::chrono::microseconds warmup;
+  std::size_t threads;
+  // Why the tuned thread count couldn't be stored, if it couldn't.
+  std::string autotuneCacheError;
+};
+
+std::size_t parseThreadCount(jsi::Runtime& runtime, const jsi::Value& value) {
+  auto threads = value.asNumber();
+  if (threads < 1 || threads != static_cast<size_t>(threads)) {
+    throw jsi::JSError(runtime, "expect threads to be a positive integer");
+  }
+  return static_cast<std::size_t>(threads);
+}
+
+LoadOptions parseLoadOptions(
+    jsi::Runtime& runtime,
+    utils::ArgumentParser& args) {
+  LoadOptions options;
+  auto mmapValue = args.keywordValue(3, "mmap");
+  if (mmapValue.isBool()) {
+    options.mmap = mmapValue.getBool();
+  } else if (!mmapValue.isUndefined()) {
+    throw jsi::JSError(
+        runtime, "expect 'mmap' to be boolean, but another type is given.");
+  }
+
+  auto warmupValue = args.keywordValue(3, "warmup");
+  if (warmupValue.isBool()) {
+    options.warmup = warmupValue.getBool();
+  } else if (warmupValue.isObject()) {
+    options.warmup = true;
+    auto warmup = warmupValue.asObject(runtime);
+    auto shapesValue = warmup.getProperty(runtime, "shapes");
+    if (!shapesValue.isUndefined()) {
+      auto shapes = shapesValue.asObject(runtime).asArray(runtime);
+      for (size_t i = 0; i < shapes.size(runtime); i++) {
+        auto shapeValue = shapes.getValueAtIndex(runtime, i);
+        std::vector<int64_t> shape;
+        utils::helpers::parseSize(runtime, &shapeValue, 0, 1, &shape);
+        options.warmupSpec.shapes.push_back(std::move(shape));
+      }
+    }
+    auto iterationsValue = warmup.getProperty(runtime, "iterations");
+    if (!iterationsValue.isUndefined()) {
+      auto iterations = iterationsValue.asNumber();
+      if (iterations < 1 || iterations != static_cast<size_t>(iterations)) {
+        throw jsi::JSError(
+            runtime, "expect warm-up iterations to be a positive integer");
+      }
+      options.warmupSpec.iterations = static_cast<size_t>(iterations);
+    }
+  } else if (!warmupValue.isUndefined()) {
+    throw jsi::JSError(
+        runtime,
+        "expect 'warmup' to be boolean or an object, but another type is "
+        "given.");
+  }
+
+  auto threadsValue = args.keywordValue(3, "threads");
+  if (threadsValue.isNumber()) {
+    options.threads = parseThreadCount(runtime, threadsValue);
+  } else if (threadsValue.isObject()) {
+    options.autotune = true;
+    auto autotune = threadsValue.asObject(runtime);
+    auto maxThreadsValue = autotune.getProperty(runtime, "maxThreads");
+    if (!maxThreadsValue.isUndefined()) {
+      options.autotuneMaxThreads = parseThreadCount(runtime, maxThreadsValue);
+    }
+    auto cachePathValue = autotune.getProperty(runtime, "cachePath");
+    if (!cachePathValue.isUndefined()) {
+      options.autotuneCachePath =
+          cachePathValue.asString(runtime).utf8(runtime);
+    }
+  } else if (!threadsValue.isUndefined()) {
+    throw jsi::JSError(
+        runtime,
+        "expect 'threads' to be a number or an object, but another type is "
+        "given.");
+  }
+  return options;
+}
+
 using _LoadForMobileAsyncTask = common::AsyncTask<
     std::tuple<
-        std::string,
+        ModelSource,
         c10::optional<at::Device>,
         ExtraFilesMap,
-        std::shared_ptr<jsi::Value>>,
+        std::shared_ptr<jsi::Value>,
+        LoadOptions>,
     std::tuple<
-        torch_::jit::mobile::Module,
+        std::shared_ptr<const mobile::ModelRegistry::Model>,
         ExtraFilesMap,
-        std::shared_ptr<jsi::Value>>>;
+        std::shared_ptr<jsi::Value>,
+        LoadStats>>;
 
 _LoadForMobileAsyncTask _loadForMobileImpl(
     [](jsi::Runtime& runtime,
@@ -53,10 +250,15 @@ _LoadForMobileAsyncTask _loadForMobileImpl(
       utils::ArgumentParser args(runtime, thisValue, arguments, count);
       args.requireNumArguments(1);
 
-      std::string filename = args[0].asString(runtime).utf8(runtime);
+      ModelSource source;
+      if (args[0].isString()) {
+        source.path = args[0].asString(runtime).utf8(runtime);
+      } else {
+        source = parseModelBytes(runtime, args[0]);
+      }
 
       c10::optional<at::Device> device = c10::nullopt;
-      if (count > 1) {
+      if (count > 1 && !args[1].isUndefined()) {
         auto deviceType = args[1].asString(runtime).utf8(runtime);
         if (deviceType == "cpu") {
           device = torch_::kCPU;
@@ -68,7 +270,7 @@ _LoadForMobileAsyncTask _loadForMobileImpl(
 
       std::unordered_map<std::string, std::string> extraFiles;
       std::shared_ptr<jsi::Value> extraFilesObject = nullptr;
-      if (count > 2) {
+      if (count > 2 && !args[2].isUndefined()) {
         jsi::Object obj = args[2].asObject(runtime);
         auto arr = obj.getPropertyNames(runtime);
         for (size_t i = 0; i < arr.length(runtime); i++) {
@@ -83,28 +285,132 @@ _LoadForMobileAsyncTask _loadForMobileImpl(
       }
 
       return std::make_tuple(
-          filename, device, std::move(extraFiles), std::move(extraFilesObject));
+          std::move(source),
+          device,
+          std::move(extraFiles),
+          std::move(extraFilesObject),
+          parseLoadOptions(runtime, args));
     },
 
     [](_LoadForMobileAsyncTask::SetupResultType&& setupResult) {
-      std::string filename;
+      ModelSource source;
       c10::optional<at::Device> device;
       ExtraFilesMap extraFiles;
       // The extraFilesObject will just be piped through to the result worker.
       std::shared_ptr<jsi::Value> extraFilesObject;
-      std::tie(filename, device, extraFiles, extraFilesObject) = setupResult;
-      auto model = torch_::jit::_load_for_mobile(filename, device, extraFiles);
+      LoadOptions options;
+      std::tie(source, device, extraFiles, extraFilesObject, options) =
+          std::move(setupResult);
+
+      // The tuned thread count is looked up by the fingerprint of the model,
+      // which is computed before the loader takes the data.
+      std::string tuningKey;
+      c10::optional<std::size_t> tunedThreads;
+      if (options.autotune) {
+        tuningKey = mobile::threadTuningKey(
+            source.data != nullptr
+                ? mobile::modelFingerprint(source.data.get(), source.size)
+                : mobile::modelFingerprint(source.path));
+        // Model files can be read-only, e.g., app assets, so the thread
+        // counts are stored in the cache directory.
+        auto cacheDirectory = filesystem::getCacheDirectory();
+        if (options.autotuneCachePath.empty() && !cacheDirectory.empty()) {
+          options.autotuneCachePath = cacheDirectory + "/" + kTuningCacheFile;
+        }
+        if (!options.autotuneCachePath.empty()) {
+          tunedThreads =
+              mobile::readTunedThreads(options.autotuneCachePath, tuningKey);
+        }
+      }
+      bool runAutotune = options.autotune && !tunedThreads.has_value();
+
+      // Read the warm-up shapes from the model, unless the caller passed them.
+      // The extra file is only reported back if the caller asked for it.
+      bool readWarmupShapes = (options.warmup || runAutotune) &&
+          options.warmupSpec.shapes.empty();
+      bool reportWarmupFile = extraFiles.count(mobile::kWarmupExtraFile) > 0;
+      if (readWarmupShapes) {
+        extraFiles[mobile::kWarmupExtraFile] = "";
+      }
+
+      using Clock = std::chrono::steady_clock;
+      auto start = Clock::now();
+      auto& registry = mobile::ModelRegistry::instance();
+      auto model = source.data != nullptr
+          ? registry.loadBuffer(
+                std::move(source.data), source.size, device, extraFiles)
+          : registry.load(source.path, device, extraFiles, options.mmap);
+      auto loaded = Clock::now();
+
+      if (readWarmupShapes) {
+        options.warmupSpec.shapes =
+            mobile::parseWarmupShapes(extraFiles[mobile::kWarmupExtraFile]);
+        if (!reportWarmupFile) {
+          extraFiles.erase(mobile::kWarmupExtraFile);
+        }
+        if (options.warmupSpec.shapes.empty()) {
+          throw std::runtime_error(
+              "warm-up and thread autotuning need input shapes, but none "
+              "were given and the model has no " +
+              std::string(mobile::kWarmupExtraFile) + " extra file");
+        }
+      }
+      // Autotuning and warm-up run like method calls, so they don't resize the
+      // intra-op threads under the calls of other models.
+      auto pool = std::make_shared<mobile::ModulePool>(model->module);
+      std::string autotuneCacheError;
+      if (runAutotune) {
+        auto maxThreads = options.autotuneMaxThreads > 0
+            ? options.autotuneMaxThreads
+            : std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+        auto tuning = mobile::autotuneIntraOpThreads(
+            *pool, options.warmupSpec, maxThreads);
+        tunedThreads = tuning.threads;
+        // The model is usable without a stored thread count, which is tuned
+        // again on the next load.
+        if (options.autotuneCachePath.empty()) {
+          autotuneCacheError = "the app has no cache directory";
+        } else {
+          try {
+            mobile::writeTunedThreads(
+                options.autotuneCachePath, tuningKey, tuning.threads);
+          } catch (const std::runtime_error& e) {
+            autotuneCacheError = e.what();
+          }
+        }
+      }
+      if (tunedThreads.has_value()) {
+        options.threads = *tunedThreads;
+      }
+      auto tuned = Clock::now();
+
+      if (options.warmup) {
+        pool->setNumThreads(options.threads);
+        mobile::warmUp(*pool, options.warmupSpec);
+      }
+      auto warmedUp = Clock::now();
+
+      using std::chrono::duration_cast;
+      using std::chrono::microseconds;
+      LoadStats stats{
+          duration_cast<microseconds>(loaded - start),
+          duration_cast<microseconds>(tuned - loaded),
+          duration_cast<microseconds>(warmedUp - tuned),
+          options.threads,
+          std::move(autotuneCacheError)};
       return std::make_tuple(
-          model, std::move(extraFiles), std::move(extraFilesObject));
+          model, std::move(extraFiles), std::move(extraFilesObject), stats);
     },
 
     [](jsi::Runtime& runtime,
        torchlive::RuntimeExecutor runtimeExecutor,
        _LoadForMobileAsyncTask::WorkResultType&& workResult) {
-      torch_::jit::mobile::Module m;
+      std::shared_ptr<const mobile::ModelRegistry::Model> model;
       ExtraFilesMap extraFiles;
       std::shared_ptr<jsi::Value> extraFilesObject;
-      std::tie(m, extraFiles, extraFilesObject) = std::move(workResult);
+      LoadStats stats;
+      std::tie(model, extraFiles, extraFilesObject, stats) =
+          std::move(workResult);
 
       // Update the extra files object passed in as third argument with the
       // extra files values retrieved on _load_for_mobile in the worker thread.
@@ -122,11 +428,69 @@ _LoadForMobileAsyncTask _loadForMobileImpl(
 
       auto moduleHostObject =
           std::make_shared<torchlive::torch::jit::mobile::ModuleHostObject>(
-              runtime, runtimeExecutor, std::move(m));
+              runtime, runtimeExecutor, std::move(model));
+      moduleHostObject->setLoadStats(
+          runtime,
+          stats.load.count() / 1000.0,
+          stats.autotune.count() / 1000.0,
+          stats.warmup.count() / 1000.0,
+          stats.autotuneCacheError);
+      moduleHostObject->setNumThreads(stats.threads);
 
       return jsi::Object::createFromHostObject(
           runtime, std::move(moduleHostObject));
-    });
+    },
+
+    // Loading a model can take seconds and shouldn't delay the inference of
+    // models that are already loaded.
+    ThreadPool::Priority::kBackground);
+
+jsi::Value getModelCacheStatsImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  auto& registry = mobile::ModelRegistry::instance();
+  auto modelStats = registry.stats();
+  auto models = jsi::Array(runtime, modelStats.size());
+  double residentBytes = 0;
+  for (size_t i = 0; i < modelStats.size(); i++) {
+    const auto& stats = modelStats[i];
+    jsi::Object model(runtime);
+    model.setProperty(
+        runtime, "path", jsi::String::createFromUtf8(runtime, stats.path));
+    model.setProperty(
+        runtime, "device", jsi::String::createFromUtf8(runtime, stats.device));
+    model.setProperty(
+        runtime, "residentBytes", static_cast<double>(stats.residentBytes));
+    model.setProperty(runtime, "inUse", stats.inUse);
+    models.setValueAtIndex(runtime, i, std::move(model));
+    residentBytes += stats.residentBytes;
+  }
+
+  jsi::Object result(runtime);
+  result.setProperty(
+      runtime, "budgetBytes", static_cast<double>(registry.budget()));
+  result.setProperty(runtime, "residentBytes", residentBytes);
+  result.setProperty(runtime, "models", std::move(models));
+  return result;
+}
+
+jsi::Value setModelCacheBudgetImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  utils::ArgumentParser args(runtime, thisValue, arguments, count);
+  args.requireNumArguments(1);
+  auto budgetBytes = args[0].asNumber();
+  if (budgetBytes < 0) {
+    throw jsi::JSError(runtime, "expect budget to be a non-negative number");
+  }
+  mobile::ModelRegistry::instance().setBudget(
+      static_cast<std::size_t>(budgetBytes));
+  return jsi::Value::undefined();
+}
 
 } // namespace
 
@@ -138,6 +502,10 @@ jsi::Object buildNamespace(jsi::Runtime& rt, torchlive::RuntimeExecutor rte) {
       rt, ns, "_loadForMobile", 1, _loadForMobileImpl.asyncPromiseFunc(rte));
   setPropertyHostFunction(
       rt, ns, "_loadForMobileSync", 1, _loadForMobileImpl.syncFunc(rte));
+  setPropertyHostFunction(
+      rt, ns, "getModelCacheStats", 0, getModelCacheStatsImpl);
+  setPropertyHostFunction(
+      rt, ns, "setModelCacheBudget", 1, setModelCacheBudgetImpl);
   return ns;
 }
 
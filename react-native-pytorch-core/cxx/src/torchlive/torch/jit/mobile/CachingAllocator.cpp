@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <atomic>
+#include <utility>
+
+#include "CachingAllocator.h"
+
+namespace torchlive {
+namespace torch {
+namespace jit {
+namespace mobile {
+
+struct CachingAllocator::Counters {
+  std::atomic<std::uint64_t> allocations{0};
+  std::atomic<std::uint64_t> hits{0};
+};
+
+// Counts the allocations of the c10 caching allocator and how many of them
+// were served from its cache.
+class CachingAllocator::Cache : public c10::CPUCachingAllocator {
+ public:
+  explicit Cache(std::shared_ptr<Counters> counters)
+      : counters_(std::move(counters)) {}
+
+  void* allocate(const size_t bytes) override {
+    bool hit;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = available_map_.find(bytes);
+      hit = it != available_map_.end() && !it->second.empty();
+    }
+    counters_->allocations++;
+    if (hit) {
+      counters_->hits++;
+    }
+    return c10::CPUCachingAllocator::allocate(bytes);
+  }
+
+  std::size_t cachedBytes() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::size_t result = 0;
+    for (const auto& entry : available_map_) {
+      result += entry.first * entry.second.size();
+    }
+    return result;
+  }
+
+ private:
+  std::shared_ptr<Counters> counters_;
+};
+
+CachingAllocator::Guard::Guard(CachingAllocator& allocator)
+    : cache_(allocator.currentCache()), guard_(cache_.get()) {}
+
+CachingAllocator::CachingAllocator()
+    : counters_(std::make_shared<Counters>()) {
+  cache_ = std::make_shared<Cache>(counters_);
+}
+
+std::shared_ptr<c10::CPUCachingAllocator> CachingAllocator::currentCache() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cache_;
+}
+
+void CachingAllocator::trim() {
+  auto cache = std::make_shared<Cache>(counters_);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::swap(cache_, cache);
+  }
+  // The c10 allocator frees its cached memory when it is destroyed, which
+  // happens here unless a call is still using it.
+  cache.reset();
+}
+
+CachingAllocator::Stats CachingAllocator::stats() {
+  auto cache = std::static_pointer_cast<Cache>(currentCache());
+  return {
+      cache->cachedBytes(),
+      counters_->allocations.load(),
+      counters_->hits.load()};
+}
+
+} // namespace mobile
+} // namespace jit
+} // namespace torch
+} // namespace torchlive
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <c10/mobile/CPUCachingAllocator.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace torchlive {
+namespace torch {
+namespace jit {
+namespace mobile {
+
+// Caches the CPU memory that tensors allocate while a module method runs, so
+// the intermediate tensors of the next call reuse it instead of allocating
+// from the system. Memory is cached by allocation size, which suits models
+// that are called repeatedly with inputs of the same sizes.
+//
+// Only allocations made within a Guard are cached. Tensors that outlive the
+// guard, like the outputs of a method, are freed normally when they are
+// released outside of a guard.
+class CachingAllocator {
+ public:
+  struct Stats {
+    // Bytes freed by method calls and kept for reuse.
+    std::size_t cachedBytes;
+    std::uint64_t allocations;
+    // Allocations served from the cache.
+    std::uint64_t hits;
+  };
+
+  // Routes the CPU allocations of the current thread to the allocator while
+  // it is alive.
+  class Guard {
+   public:
+    explicit Guard(CachingAllocator& allocator);
+
+   private:
+    // Keeps the cache alive if the allocator is trimmed during the call.
+    std::shared_ptr<c10::CPUCachingAllocator> cache_;
+    c10::WithCPUCachingAllocatorGuard guard_;
+  };
+
+  CachingAllocator();
+
+  CachingAllocator(const CachingAllocator&) = delete;
+  CachingAllocator& operator=(const CachingAllocator&) = delete;
+
+  // Returns the cached memory to the system. Memory freed by calls that are
+  // running is cached until the next trim.
+  void trim();
+
+  Stats stats();
+
+ private:
+  class Cache;
+  struct Counters;
+
+  std::shared_ptr<c10::CPUCachingAllocator> currentCache();
+
+  std::mutex mutex_;
+  std::shared_ptr<Cache> cache_;
+  // Shared with the caches, which may outlive the allocator.
+  std::shared_ptr<Counters> counters_;
+};
+
+} // namespace mobile
+} // namespace jit
+} // namespace torch
+} // namespace torchlive
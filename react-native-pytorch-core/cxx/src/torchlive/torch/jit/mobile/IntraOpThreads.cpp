@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <ATen/Functions.h>
+#include <ATen/Parallel.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "../../../filesystem/FilesystemNamespace.h"
+#include "IntraOpThreads.h"
+
+namespace torchlive {
+namespace torch {
+namespace jit {
+namespace mobile {
+
+namespace {
+
+std::atomic<std::size_t> configuredDefaultThreads(0);
+
+// The thread count PyTorch picked for the device, which is read before the
+// thread count is changed for the first time.
+std::size_t pytorchDefaultThreads() {
+  static const std::size_t threads =
+      static_cast<std::size_t>(at::get_num_threads());
+  return threads;
+}
+
+// The calls that hold the thread pool, see IntraOpThreadsCall.
+std::mutex gateMutex;
+std::condition_variable gateChanged;
+std::size_t heldCalls = 0;
+bool heldExclusively = false;
+// The calls and exclusive holds of the current thread, which nested calls
+// run within.
+thread_local std::size_t threadHolds = 0;
+
+// Resizes the pool. Must be called with the pool held exclusively, or with
+// gateMutex held and no calls holding the pool.
+void resizeIntraOpThreads(std::size_t threads) {
+  if (threads == 0) {
+    threads = defaultIntraOpThreads();
+  }
+  // Resizing the pool recreates its threads, so only do it when needed.
+  if (static_cast<std::size_t>(at::get_num_threads()) != threads) {
+    at::set_num_threads(static_cast<int>(threads));
+  }
+}
+
+std::chrono::microseconds timeForward(
+    ModulePool& pool,
+    torch_::jit::mobile::Function* forward,
+    const WarmupSpec& spec) {
+  using Clock = std::chrono::steady_clock;
+  auto iterations = std::max<std::size_t>(spec.iterations, 1);
+  Clock::duration total = Clock::duration::zero();
+  for (std::size_t i = 0; i < iterations; i++) {
+    std::vector<c10::IValue> inputs;
+    for (const auto& shape : spec.shapes) {
+      inputs.push_back(at::rand(shape));
+    }
+    auto start = Clock::now();
+    pool.run(forward, std::move(inputs));
+    total += Clock::now() - start;
+  }
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      total / iterations);
+}
+
+} // namespace
+
+std::size_t defaultIntraOpThreads() {
+  auto threads = configuredDefaultThreads.load();
+  return threads > 0 ? threads : pytorchDefaultThreads();
+}
+
+void setDefaultIntraOpThreads(std::size_t threads) {
+  pytorchDefaultThreads();
+  configuredDefaultThreads = threads;
+}
+
+IntraOpThreadsCall::IntraOpThreadsCall() {
+  enter(c10::nullopt);
+}
+
+IntraOpThreadsCall::IntraOpThreadsCall(std::size_t threads) {
+  enter(threads);
+}
+
+IntraOpThreadsCall::~IntraOpThreadsCall() {
+  threadHolds--;
+  if (nested_) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(gateMutex);
+  if (--heldCalls == 0) {
+    gateChanged.notify_all();
+  }
+}
+
+void IntraOpThreadsCall::enter(c10::optional<std::size_t> threads) {
+  nested_ = threadHolds > 0;
+  threadHolds++;
+  if (nested_) {
+    // Waiting here would deadlock with an ExclusiveIntraOpThreads that waits
+    // for the enclosing call.
+    return;
+  }
+  std::unique_lock<std::mutex> lock(gateMutex);
+  gateChanged.wait(lock, [] { return !heldExclusively; });
+  if (threads.has_value() && heldCalls == 0) {
+    resizeIntraOpThreads(*threads);
+  }
+  heldCalls++;
+}
+
+ExclusiveIntraOpThreads::ExclusiveIntraOpThreads() {
+  std::unique_lock<std::mutex> lock(gateMutex);
+  gateChanged.wait(lock, [] { return !heldExclusively; });
+  // New calls wait from here on, so the running calls can't starve the hold.
+  heldExclusively = true;
+  gateChanged.wait(lock, [] { return heldCalls == 0; });
+  threadHolds++;
+}
+
+ExclusiveIntraOpThreads::~ExclusiveIntraOpThreads() {
+  threadHolds--;
+  std::lock_guard<std::mutex> lock(gateMutex);
+  heldExclusively = false;
+  gateChanged.notify_all();
+}
+
+void ExclusiveIntraOpThreads::resize(std::size_t threads) {
+  resizeIntraOpThreads(threads);
+}
+
+ThreadTuning autotuneIntraOpThreads(
+    ModulePool& pool,
+    const WarmupSpec& spec,
+    std::size_t maxThreads) {
+  auto method = pool.module().find_method("forward");
+  if (!method.has_value()) {
+    throw std::runtime_error(
+        "thread autotuning needs a forward method, but the model has none");
+  }
+  auto forward = &method->function();
+
+  ExclusiveIntraOpThreads exclusive;
+  ThreadTuning result{1, {}};
+  for (std::size_t threads = 1; threads <= maxThreads; threads++) {
+    exclusive.resize(threads);
+    // The first call after resizing the pool is slower, so it isn't timed.
+    WarmupSpec warmup{spec.shapes, 1};
+    timeForward(pool, forward, warmup);
+    auto time = timeForward(pool, forward, spec);
+    if (result.times.empty() || time < result.times[result.threads - 1]) {
+      result.threads = threads;
+    }
+    result.times.push_back(time);
+  }
+  exclusive.resize(0);
+  return result;
+}
+
+std::string threadTuningKey(const std::string& modelFingerprint) {
+  // The best thread count depends on the cores of the device. The key must
+  // not contain spaces, which separate the fields of the tuning file.
+  return modelFingerprint + "-cpu" +
+      std::to_string(std::thread::hardware_concurrency());
+}
+
+c10::optional<std::size_t> readTunedThreads(
+    const std::string& path,
+    const std::string& key) {
+  std::ifstream file(path);
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    std::string lineKey;
+    std::size_t threads = 0;
+    if (fields >> lineKey >> threads && lineKey == key && threads > 0) {
+      return threads;
+    }
+  }
+  return c10::nullopt;
+}
+
+void writeTunedThreads(
+    const std::string& path,
+    const std::string& key,
+    std::size_t threads) {
+  std::ostringstream contents;
+  {
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+      std::istringstream fields(line);
+      std::string lineKey;
+      if (fields >> lineKey && lineKey != key) {
+        contents << line << '\n';
+      }
+    }
+  }
+  contents << key << ' ' << threads << '\n';
+  filesystem::writeFile(path, contents.str());
+}
+
+} // namespace mobile
+} // namespace jit
+} // namespace torch
+} // namespace torchlive
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+// Suppress deprecated-declarations error to support Clang/C++17
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#include <torch/csrc/jit/mobile/module.h>
+#pragma clang diagnostic pop
+
+#include <c10/util/Optional.h>
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "ModelWarmup.h"
+#include "ModulePool.h"
+
+// Namespace alias for torch to avoid namespace conflicts with torchlive::torch
+namespace torch_ = torch;
+
+namespace torchlive {
+namespace torch {
+namespace jit {
+namespace mobile {
+
+// The number of threads that operators of a call split their work across,
+// which is the size of the thread pool shared by ATen and XNNPACK. The pool is
+// process-wide, and operators use it while they run, so it is only resized
+// while no call holds it, see IntraOpThreadsCall.
+
+// Returns the thread count of calls without a thread count of their own. It
+// is the PyTorch default, unless it was changed with setDefaultIntraOpThreads.
+std::size_t defaultIntraOpThreads();
+
+// Sets the thread count of calls without a thread count of their own, or
+// restores the PyTorch default with 0. The pool is resized by the next call
+// that starts while no other call runs.
+void setDefaultIntraOpThreads(std::size_t threads);
+
+// Holds the thread pool while it is alive, e.g., for a method call. Calls
+// hold the pool at the same time, and a call resizes it to its thread count
+// only if no other call holds it. Otherwise, the call runs at the current
+// thread count, because resizing the pool frees the pool that the operators
+// of the other calls use. Calls wait while an ExclusiveIntraOpThreads holds
+// the pool. Calls nested in a call or in an ExclusiveIntraOpThreads on the
+// same thread run at the current thread count.
+class IntraOpThreadsCall {
+ public:
+  // Holds the pool at its current thread count, e.g., for tensor ops.
+  IntraOpThreadsCall();
+  // Holds the pool with the given thread count, or with the default thread
+  // count if threads is 0.
+  explicit IntraOpThreadsCall(std::size_t threads);
+  ~IntraOpThreadsCall();
+
+  IntraOpThreadsCall(const IntraOpThreadsCall&) = delete;
+  IntraOpThreadsCall& operator=(const IntraOpThreadsCall&) = delete;
+
+ private:
+  void enter(c10::optional<std::size_t> threads);
+
+  bool nested_ = false;
+};
+
+// Holds the thread pool exclusively while it is alive, e.g., to time calls
+// at different thread counts. Waits for the running calls to finish, and new
+// calls wait until it is destroyed.
+class ExclusiveIntraOpThreads {
+ public:
+  ExclusiveIntraOpThreads();
+  ~ExclusiveIntraOpThreads();
+
+  ExclusiveIntraOpThreads(const ExclusiveIntraOpThreads&) = delete;
+  ExclusiveIntraOpThreads& operator=(const ExclusiveIntraOpThreads&) = delete;
+
+  // Resizes the pool to the thread count, or to the default thread count if
+  // threads is 0.
+  void resize(std::size_t threads);
+};
+
+struct ThreadTuning {
+  // The thread count with the fastest forward call.
+  std::size_t threads;
+  // The average time of a forward call with 1, 2, ... threads.
+  std::vector<std::chrono::microseconds> times;
+};
+
+// Times the forward method of the module of the pool with random inputs of
+// the given shapes at 1 to maxThreads threads, and returns the fastest thread
+// count. Ties go to fewer threads. The calls hold the thread pool exclusively,
+// so they aren't slowed down by other calls. Throws std::runtime_error if the
+// module has no forward method.
+ThreadTuning autotuneIntraOpThreads(
+    ModulePool& pool,
+    const WarmupSpec& spec,
+    std::size_t maxThreads);
+
+// Returns a key for the tuned thread count of a model on this device, given
+// the fingerprint of the model (see modelFingerprint).
+std::string threadTuningKey(const std::string& modelFingerprint);
+
+// Returns the thread count for the key in the tuning file, if any. A missing
+// or unreadable file has no thread counts.
+c10::optional<std::size_t> readTunedThreads(
+    const std::string& path,
+    const std::string& key);
+
+// Stores the thread count for the key in the tuning file, keeping the thread
+// counts of other keys. Throws std::runtime_error if the file can't be
+// written.
+void writeTunedThreads(
+    const std::string& path,
+    const std::string& key,
+    std::size_t threads);
+
+} // namespace mobile
+} // namespace jit
+} // namespace torch
+} // namespace torchlive
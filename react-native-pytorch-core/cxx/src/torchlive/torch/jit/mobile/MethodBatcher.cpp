@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <ATen/Functions.h>
+
+#include <stdexcept>
+#include <utility>
+
+#include "../../../ThreadPool.h"
+#include "MethodBatcher.h"
+
+namespace torchlive {
+namespace torch {
+namespace jit {
+namespace mobile {
+
+namespace {
+
+// Returns whether the inputs can be concatenated along the first dimension
+// with the inputs of the first call of a batch.
+bool isBatchable(
+    const std::vector<c10::IValue>& inputs,
+    const std::vector<c10::IValue>* first) {
+  if (inputs.empty() || (first != nullptr && inputs.size() != first->size())) {
+    return false;
+  }
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (!inputs[i].isTensor()) {
+      return false;
+    }
+    const auto& tensor = inputs[i].toTensor();
+    if (tensor.dim() == 0) {
+      return false;
+    }
+    if (first == nullptr) {
+      continue;
+    }
+    const auto& other = (*first)[i].toTensor();
+    if (tensor.scalar_type() != other.scalar_type() ||
+        tensor.sizes().slice(1) != other.sizes().slice(1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the part of the batch output that belongs to one call. Tensors are
+// split along the first dimension, and other values are the same for all
+// calls.
+c10::IValue splitOutput(
+    const c10::IValue& value,
+    int64_t offset,
+    int64_t length,
+    int64_t total) {
+  if (value.isTensor()) {
+    const auto& tensor = value.toTensor();
+    if (tensor.dim() == 0 || tensor.size(0) != total) {
+      throw std::runtime_error(
+          "can't split the batch output, because a tensor doesn't have the "
+          "batch size as first dimension");
+    }
+    return tensor.narrow(0, offset, length);
+  } else if (value.isTuple()) {
+    std::vector<c10::IValue> elements;
+    for (const auto& element : value.toTupleRef().elements()) {
+      elements.push_back(splitOutput(element, offset, length, total));
+    }
+    return c10::ivalue::Tuple::create(std::move(elements));
+  } else if (value.isList()) {
+    auto list = value.toList();
+    c10::impl::GenericList result(list.elementType());
+    for (const auto& element : list) {
+      result.push_back(splitOutput(element, offset, length, total));
+    }
+    return result;
+  } else if (value.isGenericDict()) {
+    auto dict = value.toGenericDict();
+    c10::impl::GenericDict result(dict.keyType(), dict.valueType());
+    for (const auto& entry : dict) {
+      result.insert(
+          entry.key(), splitOutput(entry.value(), offset, length, total));
+    }
+    return result;
+  }
+  return value;
+}
+
+MethodBatcher::Options clampOptions(MethodBatcher::Options options) {
+  if (options.maxBatchSize > MethodBatcher::kMaxBatchSize) {
+    options.maxBatchSize = MethodBatcher::kMaxBatchSize;
+  }
+  return options;
+}
+
+} // namespace
+
+constexpr std::size_t MethodBatcher::kMaxBatchSize;
+
+MethodBatcher::MethodBatcher(
+    std::shared_ptr<ModulePool> pool,
+    torch_::jit::mobile::Function* function,
+    Options options)
+    : pool_(std::move(pool)),
+      function_(function),
+      options_(clampOptions(options)),
+      batchSizes_(options_.maxBatchSize, 0),
+      collector_([this]() { collect(); }) {}
+
+MethodBatcher::~MethodBatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  changed_.notify_all();
+  // The collector runs the pending calls before it returns.
+  collector_.join();
+}
+
+void MethodBatcher::submit(
+    std::vector<c10::IValue> inputs,
+    Callback callback) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.push_back({std::move(inputs), std::move(callback), Clock::now()});
+  }
+  changed_.notify_all();
+}
+
+std::vector<std::uint64_t> MethodBatcher::batchSizes() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return batchSizes_;
+}
+
+void MethodBatcher::collect() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    changed_.wait(lock, [this]() { return stopped_ || !pending_.empty(); });
+    if (pending_.empty()) {
+      return;
+    }
+    auto deadline = pending_.front().submitted + options_.maxDelay;
+    changed_.wait_until(lock, deadline, [this]() {
+      return stopped_ || pending_.size() >= options_.maxBatchSize;
+    });
+    auto batch = takeBatch();
+    batchSizes_[batch.size() - 1]++;
+
+    lock.unlock();
+    // Capture the pool instead of this, so batches can finish after the
+    // batcher is destroyed.
+    auto pool = pool_;
+    auto function = function_;
+    auto sharedBatch = std::make_shared<std::vector<Call>>(std::move(batch));
+    // The batch waits for a free replica without holding a thread.
+    pool->post(
+        [pool, function, sharedBatch]() {
+          runBatch(*pool, function, std::move(*sharedBatch));
+        },
+        ThreadPool::Priority::kInteractive);
+    lock.lock();
+  }
+}
+
+std::vector<MethodBatcher::Call> MethodBatcher::takeBatch() {
+  std::vector<Call> batch;
+  batch.push_back(std::move(pending_.front()));
+  pending_.pop_front();
+  const auto& first = batch.front().inputs;
+  if (!isBatchable(first, nullptr)) {
+    return batch;
+  }
+  for (auto it = pending_.begin();
+       it != pending_.end() && batch.size() < options_.maxBatchSize;) {
+    if (isBatchable(it->inputs, &first)) {
+      batch.push_back(std::move(*it));
+      it = pending_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return batch;
+}
+
+void MethodBatcher::runBatch(
+    ModulePool& pool,
+    torch_::jit::mobile::Function* function,
+    std::vector<Call> batch) {
+  std::vector<c10::IValue> outputs;
+  try {
+    if (batch.size() == 1) {
+      outputs.push_back(pool.run(function, std::move(batch[0].inputs)));
+    } else {
+      std::vector<c10::IValue> inputs;
+      for (size_t i = 0; i < batch[0].inputs.size(); i++) {
+        std::vector<at::Tensor> tensors;
+        for (const auto& call : batch) {
+          tensors.push_back(call.inputs[i].toTensor());
+        }
+        inputs.push_back(at::cat(tensors, 0));
+      }
+      auto total = inputs[0].toTensor().size(0);
+      auto output = pool.run(function, std::move(inputs));
+      int64_t offset = 0;
+      for (const auto& call : batch) {
+        auto length = call.inputs[0].toTensor().size(0);
+        outputs.push_back(splitOutput(output, offset, length, total));
+        offset += length;
+      }
+    }
+  } catch (...) {
+    auto error = std::current_exception();
+    for (auto& call : batch) {
+      call.callback(c10::IValue(), error);
+    }
+    return;
+  }
+  for (size_t i = 0; i < batch.size(); i++) {
+    batch[i].callback(std::move(outputs[i]), nullptr);
+  }
+}
+
+} // namespace mobile
+} // namespace jit
+} // namespace torch
+} // namespace torchlive
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+// Suppress deprecated-declarations error to support Clang/C++17
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#include <torch/csrc/jit/mobile/module.h>
+#pragma clang diagnostic pop
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ModulePool.h"
+
+// Namespace alias for torch to avoid namespace conflicts with torchlive::torch
+namespace torch_ = torch;
+
+namespace torchlive {
+namespace torch {
+namespace jit {
+namespace mobile {
+
+// Combines concurrent calls of a module method into batches. Calls whose
+// arguments are all tensors with the same dtype and the same sizes except for
+// the first dimension are concatenated along the first dimension, run as one
+// call, and the outputs are split along the first dimension. Calls that can't
+// be combined run on their own.
+//
+// A batch runs when it has maxBatchSize calls or when its first call waited
+// for maxDelay, whichever comes first. maxBatchSize is clamped to
+// kMaxBatchSize.
+class MethodBatcher {
+ public:
+  static constexpr std::size_t kMaxBatchSize = 256;
+
+  struct Options {
+    std::size_t maxBatchSize;
+    std::chrono::microseconds maxDelay;
+  };
+
+  // Called on a worker thread with the output of the call, or with the error
+  // of the batch.
+  using Callback = std::function<void(c10::IValue, std::exception_ptr)>;
+
+  MethodBatcher(
+      std::shared_ptr<ModulePool> pool,
+      torch_::jit::mobile::Function* function,
+      Options options);
+  ~MethodBatcher();
+
+  MethodBatcher(const MethodBatcher&) = delete;
+  MethodBatcher& operator=(const MethodBatcher&) = delete;
+
+  void submit(std::vector<c10::IValue> inputs, Callback callback);
+
+  // Returns the number of batches of each size, where the element at index i
+  // counts batches of i + 1 calls.
+  std::vector<std::uint64_t> batchSizes();
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Call {
+    std::vector<c10::IValue> inputs;
+    Callback callback;
+    Clock::time_point submitted;
+  };
+
+  // Collects calls into batches and hands them to the thread pool.
+  void collect();
+
+  // Removes the next batch from the pending calls. Must be called with mutex_
+  // held.
+  std::vector<Call> takeBatch();
+
+  // Runs the calls of the batch as one call and passes each call its part of
+  // the output.
+  static void runBatch(
+      ModulePool& pool,
+      torch_::jit::mobile::Function* function,
+      std::vector<Call> batch);
+
+  std::shared_ptr<ModulePool> pool_;
+  torch_::jit::mobile::Function* function_;
+  Options options_;
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  std::deque<Call> pending_;
+  std::vector<std::uint64_t> batchSizes_;
+  bool stopped_ = false;
+  std::thread collector_;
+};
+
+} // namespace mobile
+} // namespace jit
+} // namespace torch
+} // namespace torchlive
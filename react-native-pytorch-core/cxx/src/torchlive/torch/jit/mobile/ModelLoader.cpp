@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Suppress deprecated-declarations error to support Clang/C++17
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#ifdef TORCHLIVE_FLATBUFFER_LOADER
+#include <torch/csrc/jit/mobile/flatbuffer_loader.h>
+#endif
+#include <torch/csrc/jit/mobile/import.h>
+#pragma clang diagnostic pop
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "ModelLoader.h"
+
+namespace torchlive {
+namespace torch {
+namespace jit {
+namespace mobile {
+
+namespace {
+
+// The file identifier of flatbuffer mobile models, which flatbuffers stores
+// after the 4 byte root table offset.
+constexpr char kFlatbufferIdentifier[] = "PTMF";
+constexpr std::size_t kFlatbufferIdentifierOffset = 4;
+constexpr std::size_t kFlatbufferIdentifierSize = 4;
+
+std::runtime_error fileError(
+    const std::string& message,
+    const std::string& path) {
+  return std::runtime_error(message + " " + path + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+BufferReadAdapter::BufferReadAdapter(
+    std::shared_ptr<char> data,
+    std::size_t size)
+    : data_(std::move(data)), size_(size) {}
+
+std::size_t BufferReadAdapter::size() const {
+  return size_;
+}
+
+std::size_t BufferReadAdapter::read(
+    std::uint64_t pos,
+    void* buf,
+    std::size_t n,
+    const char* what) const {
+  if (pos >= size_) {
+    return 0;
+  }
+  auto count = std::min<std::size_t>(n, size_ - pos);
+  std::memcpy(buf, data_.get() + pos, count);
+  return count;
+}
+
+std::shared_ptr<char> mapFile(const std::string& path, std::size_t* size) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw fileError("failed to open", path);
+  }
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0) {
+    auto error = fileError("failed to stat", path);
+    close(fd);
+    throw error;
+  }
+  *size = static_cast<std::size_t>(fileStat.st_size);
+  if (*size == 0) {
+    close(fd);
+    throw std::runtime_error("model file is empty: " + path);
+  }
+  // The mapping is writable, but private, because the flatbuffer loader
+  // expects mutable data.
+  void* data =
+      mmap(nullptr, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  // The mapping keeps the file referenced, so the descriptor isn't needed.
+  close(fd);
+  if (data == MAP_FAILED) {
+    throw fileError("failed to map", path);
+  }
+  auto mappedSize = *size;
+  return std::shared_ptr<char>(
+      static_cast<char*>(data),
+      [mappedSize](char* data) { munmap(data, mappedSize); });
+}
+
+bool isFlatbufferModel(const char* data, std::size_t size) {
+  return size >= kFlatbufferIdentifierOffset + kFlatbufferIdentifierSize &&
+      std::memcmp(
+          data + kFlatbufferIdentifierOffset,
+          kFlatbufferIdentifier,
+          kFlatbufferIdentifierSize) == 0;
+}
+
+torch_::jit::mobile::Module loadFromBuffer(
+    std::shared_ptr<char> data,
+    std::size_t size,
+    c10::optional<at::Device> device,
+    ExtraFilesMap& extraFiles) {
+  if (isFlatbufferModel(data.get(), size)) {
+#ifdef TORCHLIVE_FLATBUFFER_LOADER
+    // The module references the tensor data in the buffer, and keeps the
+    // buffer alive.
+    return torch_::jit::parse_and_initialize_mobile_module(
+        std::move(data), size, device, &extraFiles);
+#else
+    throw std::runtime_error(
+        "flatbuffer models are not supported by this PyTorch build");
+#endif
+  }
+  return torch_::jit::_load_for_mobile(
+      std::make_unique<BufferReadAdapter>(std::move(data), size),
+      device,
+      extraFiles);
+}
+
+} // namespace mobile
+} // namespace jit
+} // namespace torch
+} // namespace torchlive
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+// Suppress deprecated-declarations error to support Clang/C++17
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#include <caffe2/serialize/read_adapter_interface.h>
+#include <torch/csrc/jit/mobile/module.h>
+#pragma clang diagnostic pop
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Namespace alias for torch to avoid namespace conflicts with torchlive::torch
+namespace torch_ = torch;
+
+namespace torchlive {
+namespace torch {
+namespace jit {
+namespace mobile {
+
+using ExtraFilesMap = std::unordered_map<std::string, std::string>;
+
+// A read adapter over model data in memory, e.g., a memory-mapped file. The
+// data is not copied and is kept alive by the adapter.
+class BufferReadAdapter : public caffe2::serialize::ReadAdapterInterface {
+ public:
+  BufferReadAdapter(std::shared_ptr<char> data, std::size_t size);
+
+  std::size_t size() const override;
+
+  std::size_t read(
+      std::uint64_t pos,
+      void* buf,
+      std::size_t n,
+      const char* what = "") const override;
+
+ private:
+  std::shared_ptr<char> data_;
+  std::size_t size_;
+};
+
+// Maps the file into memory. Pages are read from the file on first access,
+// and writes to the mapping are private to the process.
+std::shared_ptr<char> mapFile(const std::string& path, std::size_t* size);
+
+// Returns whether the data is a model in the flatbuffer mobile format.
+bool isFlatbufferModel(const char* data, std::size_t size);
+
+// Loads a model from data in memory. Models in the zip format are read
+// through a BufferReadAdapter, which copies their tensor data. Models in the
+// flatbuffer format reference their tensor data in place, but only with
+// TORCHLIVE_FLATBUFFER_LOADER, which must only be defined for PyTorch builds
+// that include the flatbuffer loader. The prebuilt PyTorch Mobile libraries
+// don't, so the shipped builds throw for flatbuffer models.
+torch_::jit::mobile::Module loadFromBuffer(
+    std::shared_ptr<char> data,
+    std::size_t size,
+    c10::optional<at::Device> device,
+    ExtraFilesMap& extraFiles);
+
+} // namespace mobile
+} // namespace jit
+} // namespace torch
+} // namespace torchlive
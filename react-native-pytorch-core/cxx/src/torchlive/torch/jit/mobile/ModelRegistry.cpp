@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// Suppress deprecated-declarations error to support Clang/C++17
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#include <torch/csrc/jit/mobile/code.h>
+#include <torch/csrc/jit/mobile/function.h>
+#include <torch/csrc/jit/mobile/import.h>
+#pragma clang diagnostic pop
+
+#include <sys/stat.h>
+
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <unordered_set>
+#include <utility>
+
+#include "ModelLoader.h"
+#include "ModelRegistry.h"
+
+namespace torchlive {
+namespace torch {
+namespace jit {
+namespace mobile {
+
+namespace {
+
+// Bytes hashed at the start and at the end of a model file.
+constexpr std::size_t kFingerprintChunkBytes = 64 * 1024;
+
+std::uint64_t fnv1a(const char* data, std::size_t size, std::uint64_t hash) {
+  for (std::size_t i = 0; i < size; i++) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+void addResidentBytes(
+    const c10::IValue& value,
+    std::unordered_set<const void*>& storages,
+    std::size_t* bytes) {
+  if (value.isTensor()) {
+    const auto& tensor = value.toTensor();
+    if (tensor.defined() && tensor.has_storage()) {
+      const auto& storage = tensor.storage();
+      if (storages.insert(storage.unsafeGetStorageImpl()).second) {
+        *bytes += storage.nbytes();
+      }
+    }
+  } else if (value.isObject()) {
+    for (const auto& slot : value.toObjectRef().slots()) {
+      addResidentBytes(slot, storages, bytes);
+    }
+  } else if (value.isList()) {
+    for (const auto& element : value.toListRef()) {
+      addResidentBytes(element, storages, bytes);
+    }
+  } else if (value.isTuple()) {
+    for (const auto& element : value.toTupleRef().elements()) {
+      addResidentBytes(element, storages, bytes);
+    }
+  } else if (value.isGenericDict()) {
+    for (const auto& entry : value.toGenericDict()) {
+      addResidentBytes(entry.key(), storages, bytes);
+      addResidentBytes(entry.value(), storages, bytes);
+    }
+  }
+}
+
+// Returns the size of the tensor storages of the module. Weights are either
+// module attributes or, for frozen models, constants of the methods.
+std::size_t computeResidentBytes(const torch_::jit::mobile::Module& module) {
+  std::unordered_set<const void*> storages;
+  std::size_t bytes = 0;
+  addResidentBytes(c10::IValue(module._ivalue()), storages, &bytes);
+  for (const auto& method : module.compilation_unit().methods()) {
+    for (const auto& constant : method->get_code().constants_) {
+      addResidentBytes(constant, storages, &bytes);
+    }
+  }
+  return bytes;
+}
+
+// Fills in the requested extra files from the model. Extra files are only
+// read on load, so a loaded model can only be used if it has all requested
+// extra files. Returns whether it has.
+bool copyExtraFiles(
+    const ModelRegistry::Model& model,
+    ModelRegistry::ExtraFilesMap& extraFiles) {
+  for (auto& extraFile : extraFiles) {
+    auto it = model.extraFiles.find(extraFile.first);
+    if (it == model.extraFiles.end()) {
+      return false;
+    }
+    extraFile.second = it->second;
+  }
+  return true;
+}
+
+} // namespace
+
+// Hashing a whole model file would cost about as much as loading it, so the
+// fingerprint only hashes the first and last bytes of the file.
+std::string modelFingerprint(const std::string& path) {
+  struct stat fileStat;
+  if (stat(path.c_str(), &fileStat) != 0) {
+    // Let _load_for_mobile report the error.
+    return "";
+  }
+  std::uint64_t hash = 14695981039346656037ULL;
+  std::ifstream file(path, std::ios::binary);
+  std::vector<char> buffer(kFingerprintChunkBytes);
+  file.read(buffer.data(), buffer.size());
+  hash = fnv1a(buffer.data(), file.gcount(), hash);
+  auto size = static_cast<std::size_t>(fileStat.st_size);
+  if (size > 2 * kFingerprintChunkBytes) {
+    file.clear();
+    file.seekg(size - kFingerprintChunkBytes);
+    file.read(buffer.data(), buffer.size());
+    hash = fnv1a(buffer.data(), file.gcount(), hash);
+  }
+  std::ostringstream stream;
+  stream << size << ':' << fileStat.st_mtime << ':' << std::hex << hash;
+  return stream.str();
+}
+
+std::string modelFingerprint(const char* data, std::size_t size) {
+  std::uint64_t hash = 14695981039346656037ULL;
+  if (size > 2 * kFingerprintChunkBytes) {
+    hash = fnv1a(data, kFingerprintChunkBytes, hash);
+    hash = fnv1a(
+        data + size - kFingerprintChunkBytes, kFingerprintChunkBytes, hash);
+  } else {
+    hash = fnv1a(data, size, hash);
+  }
+  std::ostringstream stream;
+  stream << size << ':' << std::hex << hash;
+  return stream.str();
+}
+
+constexpr std::size_t ModelRegistry::kDefaultBudgetBytes;
+
+ModelRegistry& ModelRegistry::instance() {
+  static ModelRegistry registry;
+  return registry;
+}
+
+std::shared_ptr<const ModelRegistry::Model> ModelRegistry::load(
+    const std::string& path,
+    c10::optional<at::Device> device,
+    ExtraFilesMap& extraFiles,
+    bool memoryMap) {
+  auto deviceName = device.has_value() ? device->str() : "";
+  auto contentFingerprint = modelFingerprint(path);
+  auto key = path + '\n' + contentFingerprint + '\n' + deviceName;
+
+  std::promise<std::shared_ptr<const Model>> loaded;
+  while (true) {
+    std::shared_future<std::shared_ptr<const Model>> loading;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = index_.find(key);
+      if (it != index_.end() && !contentFingerprint.empty() &&
+          copyExtraFiles(*it->second->model, extraFiles)) {
+        touch(it->second);
+        return it->second->model;
+      }
+      auto loadingIt = loading_.find(key);
+      if (loadingIt == loading_.end() || contentFingerprint.empty()) {
+        if (!contentFingerprint.empty()) {
+          loading_[key] = loaded.get_future().share();
+        }
+        break;
+      }
+      loading = loadingIt->second;
+    }
+    // Wait for the load of the same model that is in flight, so the model is
+    // only loaded once. If that load fails, the error is thrown here too.
+    auto model = loading.get();
+    if (copyExtraFiles(*model, extraFiles)) {
+      return model;
+    }
+    // The model doesn't have all requested extra files, so load it again.
+  }
+
+  // Load without holding the lock, so models can load concurrently.
+  std::shared_ptr<const Model> model;
+  try {
+    torch_::jit::mobile::Module module;
+    if (memoryMap) {
+      std::size_t size;
+      auto data = mobile::mapFile(path, &size);
+      module = loadFromBuffer(std::move(data), size, device, extraFiles);
+    } else {
+      module = torch_::jit::_load_for_mobile(path, device, extraFiles);
+    }
+    model = std::make_shared<const Model>(Model{
+        path, deviceName, module, extraFiles, computeResidentBytes(module)});
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    loading_.erase(key);
+    loaded.set_exception(std::current_exception());
+    throw;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    // Replace the cached model. Users of the replaced model keep it alive.
+    residentBytes_ -= it->second->model->residentBytes;
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+  entries_.push_front({key, model});
+  index_[key] = entries_.begin();
+  residentBytes_ += model->residentBytes;
+  trim();
+  loading_.erase(key);
+  loaded.set_value(model);
+  return model;
+}
+
+std::shared_ptr<const ModelRegistry::Model> ModelRegistry::loadBuffer(
+    std::shared_ptr<char> data,
+    std::size_t size,
+    c10::optional<at::Device> device,
+    ExtraFilesMap& extraFiles) {
+  auto module = loadFromBuffer(std::move(data), size, device, extraFiles);
+  auto deviceName = device.has_value() ? device->str() : "";
+  return std::make_shared<const Model>(Model{
+      "", deviceName, module, extraFiles, computeResidentBytes(module)});
+}
+
+void ModelRegistry::release(std::shared_ptr<const Model> model) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+    if (it->model == model) {
+      touch(it);
+      break;
+    }
+  }
+  // Drop the caller's reference before trimming, so the model counts as idle.
+  model.reset();
+  trim();
+}
+
+void ModelRegistry::setBudget(std::size_t budgetBytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  budgetBytes_ = budgetBytes;
+  trim();
+}
+
+std::size_t ModelRegistry::budget() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return budgetBytes_;
+}
+
+std::vector<ModelRegistry::ModelStats> ModelRegistry::stats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<ModelStats> result;
+  result.reserve(entries_.size());
+  for (const auto& entry : entries_) {
+    result.push_back(
+        {entry.model->path,
+         entry.model->device,
+         entry.model->residentBytes,
+         entry.model.use_count() > 1});
+  }
+  return result;
+}
+
+void ModelRegistry::touch(std::list<Entry>::iterator it) {
+  entries_.splice(entries_.begin(), entries_, it);
+}
+
+void ModelRegistry::trim() {
+  // New references to a model are only handed out with mutex_ held, so a
+  // model with a use count of 1 is idle and stays idle while trimming.
+  auto it = entries_.end();
+  while (residentBytes_ > budgetBytes_ && it != entries_.begin()) {
+    --it;
+    if (it->model.use_count() == 1) {
+      residentBytes_ -= it->model->residentBytes;
+      index_.erase(it->key);
+      it = entries_.erase(it);
+    }
+  }
+}
+
+} // namespace mobile
+} // namespace jit
+} // namespace torch
+} // namespace torchlive
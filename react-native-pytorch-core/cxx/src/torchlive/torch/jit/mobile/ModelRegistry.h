@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+// Suppress deprecated-declarations error to support Clang/C++17
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#include <torch/csrc/jit/mobile/module.h>
+#pragma clang diagnostic pop
+
+#include <cstddef>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Namespace alias for torch to avoid namespace conflicts with torchlive::torch
+namespace torch_ = torch;
+
+namespace torchlive {
+namespace torch {
+namespace jit {
+namespace mobile {
+
+// Returns a fingerprint of the content of a model file, which combines the
+// file size and modification time with a hash of the first and last 64 KiB of
+// the file. Returns an empty string if the file doesn't exist.
+std::string modelFingerprint(const std::string& path);
+
+// Same as above for model bytes in memory, which have no modification time.
+std::string modelFingerprint(const char* data, std::size_t size);
+
+// A process-wide registry of loaded mobile modules. Loading the same model
+// file for the same device twice returns the same module, so the weights are
+// only resident once. Models that are no longer used by any module host
+// object stay in the registry for reuse, and are evicted in least recently
+// used order when the resident size of all models exceeds the budget.
+class ModelRegistry {
+ public:
+  using ExtraFilesMap = std::unordered_map<std::string, std::string>;
+
+  struct Model {
+    std::string path;
+    std::string device;
+    torch_::jit::mobile::Module module;
+    // Extra files read when the model was loaded.
+    ExtraFilesMap extraFiles;
+    // Size of the tensor storages of the model, e.g., weights.
+    std::size_t residentBytes;
+  };
+
+  struct ModelStats {
+    std::string path;
+    std::string device;
+    std::size_t residentBytes;
+    // Whether the model is used by a module, i.e., can't be evicted.
+    bool inUse;
+  };
+
+  static constexpr std::size_t kDefaultBudgetBytes = 256 * 1024 * 1024;
+
+  static ModelRegistry& instance();
+
+  // Returns the model for the given file and device, loading it if needed.
+  // The requested extra files are filled in from the model. The model stays
+  // in use until the returned pointer and all its copies are released, after
+  // which release should be called. Concurrent loads of the same model wait
+  // for the first load instead of loading the model again.
+  //
+  // With memoryMap, the model is loaded from a memory mapping of the file (see
+  // loadFromBuffer) instead of reading the file into memory.
+  std::shared_ptr<const Model> load(
+      const std::string& path,
+      c10::optional<at::Device> device,
+      ExtraFilesMap& extraFiles,
+      bool memoryMap = false);
+
+  // Loads a model from bytes in memory (see loadFromBuffer). Models loaded
+  // from memory have no path to identify them, so they are not shared and
+  // are not counted against the budget.
+  std::shared_ptr<const Model> loadBuffer(
+      std::shared_ptr<char> data,
+      std::size_t size,
+      c10::optional<at::Device> device,
+      ExtraFilesMap& extraFiles);
+
+  // Marks the model as recently used and evicts idle models if the registry
+  // is over budget. Called when a user of the model releases it.
+  void release(std::shared_ptr<const Model> model);
+
+  void setBudget(std::size_t budgetBytes);
+
+  std::size_t budget();
+
+  std::vector<ModelStats> stats();
+
+ private:
+  struct Entry {
+    std::string key;
+    std::shared_ptr<const Model> model;
+  };
+
+  ModelRegistry() = default;
+
+  // Moves the entry to the front of the LRU list. Must be called with mutex_
+  // held.
+  void touch(std::list<Entry>::iterator it);
+
+  // Evicts idle models, least recently used first, until the resident size is
+  // within budget. Must be called with mutex_ held.
+  void trim();
+
+  std::mutex mutex_;
+  // Entries in most recently used order.
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+  // Loads in flight by key, which concurrent loads of the same model wait
+  // for instead of loading it again.
+  std::unordered_map<
+      std::string,
+      std::shared_future<std::shared_ptr<const Model>>>
+      loading_;
+  std::size_t residentBytes_ = 0;
+  std::size_t budgetBytes_ = kDefaultBudgetBytes;
+};
+
+} // namespace mobile
+} // namespace jit
+} // namespace torch
+} // namespace torchlive
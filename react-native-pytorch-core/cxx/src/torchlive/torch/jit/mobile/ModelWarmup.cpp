@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <ATen/Functions.h>
+
+#include <cctype>
+#include <sstream>
+#include <stdexcept>
+
+#include "ModelWarmup.h"
+
+namespace torchlive {
+namespace torch {
+namespace jit {
+namespace mobile {
+
+std::vector<std::vector<int64_t>> parseWarmupShapes(const std::string& text) {
+  std::vector<std::vector<int64_t>> shapes;
+  std::istringstream lines(text);
+  std::string line;
+  while (std::getline(lines, line)) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos) {
+      continue;
+    }
+    std::vector<int64_t> shape;
+    std::istringstream sizes(line);
+    std::string size;
+    while (std::getline(sizes, size, ',')) {
+      // Allow spaces around sizes, e.g., "1, 3, 224, 224".
+      auto begin = size.find_first_not_of(" \t\r");
+      auto end = size.find_last_not_of(" \t\r");
+      if (begin == std::string::npos) {
+        throw std::invalid_argument("empty size in warm-up shape: " + line);
+      }
+      size = size.substr(begin, end - begin + 1);
+      for (char c : size) {
+        if (!std::isdigit(static_cast<unsigned char>(c))) {
+          throw std::invalid_argument("invalid size in warm-up shape: " + line);
+        }
+      }
+      shape.push_back(std::stoll(size));
+    }
+    if (!shape.empty()) {
+      shapes.push_back(std::move(shape));
+    }
+  }
+  return shapes;
+}
+
+void warmUp(ModulePool& pool, const WarmupSpec& spec) {
+  auto method = pool.module().find_method("forward");
+  if (!method.has_value()) {
+    throw std::runtime_error(
+        "warm-up needs a forward method, but the model has none");
+  }
+  for (std::size_t i = 0; i < spec.iterations; i++) {
+    std::vector<c10::IValue> inputs;
+    for (const auto& shape : spec.shapes) {
+      inputs.push_back(at::rand(shape));
+    }
+    pool.run(&method->function(), std::move(inputs));
+  }
+}
+
+} // namespace mobile
+} // namespace jit
+} // namespace torch
+} // namespace torchlive
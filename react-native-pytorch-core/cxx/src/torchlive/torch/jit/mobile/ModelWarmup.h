@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+// Suppress deprecated-declarations error to support Clang/C++17
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#include <torch/csrc/jit/mobile/module.h>
+#pragma clang diagnostic pop
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ModulePool.h"
+
+// Namespace alias for torch to avoid namespace conflicts with torchlive::torch
+namespace torch_ = torch;
+
+namespace torchlive {
+namespace torch {
+namespace jit {
+namespace mobile {
+
+// The extra file with the warm-up input shapes of a model, one input per line
+// with comma-separated sizes, e.g., "1,3,224,224".
+constexpr const char* kWarmupExtraFile = "warmup.txt";
+
+// Synthetic inputs to run through a model after loading it, so lazy
+// initialization like kernel setup, weight prepacking and allocator growth
+// doesn't slow down the first real call.
+struct WarmupSpec {
+  // The sizes of the float tensor inputs of the forward method.
+  std::vector<std::vector<int64_t>> shapes;
+  std::size_t iterations = 1;
+};
+
+// Parses input shapes in the format of kWarmupExtraFile. Throws
+// std::invalid_argument if a size is not a non-negative integer.
+std::vector<std::vector<int64_t>> parseWarmupShapes(const std::string& text);
+
+// Runs the forward method of the module of the pool with random inputs of
+// the given shapes, see ModulePool::run. Throws std::runtime_error if the
+// module has no forward method.
+void warmUp(ModulePool& pool, const WarmupSpec& spec);
+
+} // namespace mobile
+} // namespace jit
+} // namespace torch
+} // namespace torchlive
@@ -11,14 +11,27 @@
 #include <torch/csrc/jit/mobile/module.h>
 #pragma clang diagnostic pop
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <utility>
+#include <vector>
 
+#include "../../../Promise.h"
+#include "../../../filesystem/FilesystemNamespace.h"
 #include "../../../torchlive.h"
 #include "../../IValueHostObject.h"
 #include "../../TensorHostObject.h"
+#include "../../utils/ArgumentParser.h"
 #include "../../utils/converter.h"
 #include "../../utils/helpers.h"
+#include "IntraOpThreads.h"
 #include "ModuleHostObject.h"
+#include "OpProfiler.h"
 
 // Namespace alias for torch to avoid namespace conflicts with torchlive::torch
 namespace torch_ = torch;
@@ -30,6 +43,18 @@ namespace mobile {
 
 using namespace facebook;
 
+// A method resolved once, with the argument types used to convert the
+// JavaScript arguments of each call.
+struct MethodPlan {
+  // The replicas of the module to call the function on. The module keeps the
+  // compilation unit owning the function alive.
+  std::shared_ptr<ModulePool> pool;
+  torch_::jit::mobile::Function* function;
+  // The types of the arguments following self.
+  std::vector<c10::DynamicType*> argumentTypes;
+  std::shared_ptr<const OutputOptions> outputOptions;
+};
+
 namespace {
 std::string getSyncMethodPrefix(const std::string& propName) {
   const std::string syncSuffix = "Sync";
@@ -45,57 +70,216 @@ std::string getSyncMethodPrefix(const std::string& propName) {
   return propName.substr(0, prefixLength);
 }
 
+std::shared_ptr<const MethodPlan> createMethodPlan(
+    const torch_::jit::mobile::Module& m,
+    std::shared_ptr<ModulePool> pool,
+    std::shared_ptr<const OutputOptions> outputOptions,
+    const std::string& functionName) {
+  auto plan = std::make_shared<MethodPlan>();
+  plan->pool = std::move(pool);
+  plan->outputOptions = std::move(outputOptions);
+  plan->function = &m.get_method(functionName).function();
+  const auto& args = plan->function->getSchema().arguments();
+  for (size_t i = 1; i < args.size(); i++) {
+    // The schema owns the types, and the compilation unit owns the schema.
+    plan->argumentTypes.push_back(
+        &args[i].type()->expectRef<c10::DynamicType>());
+  }
+  return plan;
+}
+
+// Prepares the output of a call for convertOutput. This runs on the worker
+// thread, so the JavaScript thread only creates the JavaScript values.
+MethodOutput prepareOutput(OutputMode mode, torch_::jit::IValue value) {
+  MethodOutput output;
+  output.mode = mode;
+  if (mode == OutputMode::kLazy || mode == OutputMode::kRaw) {
+    output.value = std::move(value);
+  } else {
+    output.staged = utils::converter::stageIValue(
+        value, mode == OutputMode::kTypedArrays);
+  }
+  return output;
+}
+
+jsi::Value convertOutput(jsi::Runtime& runtime, MethodOutput&& output) {
+  if (output.mode == OutputMode::kLazy) {
+    return utils::converter::ivalueToLazyJSIValue(runtime, output.value);
+  } else if (output.mode == OutputMode::kRaw) {
+    return utils::helpers::createFromHostObject<torch::IValueHostObject>(
+        runtime, std::move(output.value));
+  }
+  return utils::converter::stagedValueToJSIValue(
+      runtime, std::move(output.staged));
+}
+
+std::vector<torch_::jit::IValue> convertArguments(
+    jsi::Runtime& runtime,
+    const MethodPlan& plan,
+    const jsi::Value* arguments,
+    size_t count) {
+  // Two Cases in terms of number of argument required and argument
+  // provided
+  // Case 1 (n_required < n_provided) we ignore the extra provided args,
+  // respecting Js convention
+  // Case 2 (n_required >= n_provided) we process the provided argument
+  // and let libtorch check if they are enough, this would handle module
+  // with default parameters
+  size_t argCount = std::min(count, plan.argumentTypes.size());
+
+  std::vector<torch_::jit::IValue> input;
+  input.reserve(argCount);
+  for (size_t i = 0; i < argCount; i++) {
+    input.push_back(utils::converter::jsiValuetoIValue(
+        runtime, arguments[i], *plan.argumentTypes[i]));
+  }
+  return input;
+}
+
+// Runs the calls of a method in latest-wins mode one at a time. While a call
+// runs, the newest call waits until the running call settles its Promise, and
+// a waiting call that is replaced by a newer call is cancelled, so it rejects
+// its Promise without running.
+class LatestWinsQueue : public std::enable_shared_from_this<LatestWinsQueue> {
+ public:
+  explicit LatestWinsQueue(torchlive::RuntimeExecutor runtimeExecutor)
+      : runtimeExecutor_(std::move(runtimeExecutor)) {}
+
+  void schedule(
+      std::shared_ptr<ModulePool> pool,
+      std::function<void()> work,
+      ThreadPool::Priority priority,
+      std::shared_ptr<common::CancellationToken> token) {
+    Call call{std::move(pool), std::move(work), priority, std::move(token)};
+    Call superseded;
+    bool startNow = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (running_) {
+        superseded = std::move(waiting_);
+        waiting_ = std::move(call);
+      } else {
+        running_ = startNow = true;
+      }
+    }
+    if (startNow) {
+      start(std::move(call));
+    } else if (superseded.work != nullptr) {
+      superseded.token->cancel();
+      // The work only rejects the Promise of the cancelled call, so it
+      // doesn't wait for a replica.
+      ThreadPool::pool()->run(std::move(superseded.work), superseded.priority);
+    }
+  }
+
+ private:
+  struct Call {
+    std::shared_ptr<ModulePool> pool;
+    std::function<void()> work;
+    ThreadPool::Priority priority;
+    std::shared_ptr<common::CancellationToken> token;
+  };
+
+  void start(Call call) {
+    auto self = shared_from_this();
+    auto work = std::move(call.work);
+    call.pool->post(
+        [self, work]() {
+          work();
+          // The work posted the settling of the Promise to the JavaScript
+          // thread, so the next call starts after it.
+          self->runtimeExecutor_([self](jsi::Runtime&) { self->finish(); });
+        },
+        call.priority);
+  }
+
+  // Starts the waiting call, if any, after the running call settled.
+  void finish() {
+    Call next;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (waiting_.work == nullptr) {
+        running_ = false;
+        return;
+      }
+      next = std::move(waiting_);
+      waiting_ = Call();
+    }
+    start(std::move(next));
+  }
+
+  torchlive::RuntimeExecutor runtimeExecutor_;
+  std::mutex mutex_;
+  bool running_ = false;
+  // The waiting call, which has no work if no call waits.
+  Call waiting_;
+};
+
 MethodAsyncTask createMethodAsyncTask(
-    torch_::jit::mobile::Module& m,
-    std::string functionName) {
+    std::shared_ptr<const MethodPlan> plan,
+    MethodAsyncTask::ScheduleFunctionType scheduleFunc = nullptr) {
+  if (scheduleFunc == nullptr) {
+    // Async calls wait for a free replica without holding a thread.
+    scheduleFunc = [](const MethodAsyncTask::SetupResultType& setupResult,
+                      std::function<void()> work,
+                      ThreadPool::Priority priority) {
+      std::get<0>(setupResult)->post(std::move(work), priority);
+    };
+  }
   return MethodAsyncTask(
-      [&, functionName](
+      [plan](
           jsi::Runtime& runtime,
           const jsi::Value& thisValue,
           const jsi::Value* arguments,
           size_t count) -> MethodAsyncTask::SetupResultType {
-        auto thiz =
-            thisValue.asObject(runtime).asHostObject<ModuleHostObject>(runtime);
-
-        auto args = thiz->mobileModule.get_method(functionName)
-                        .function()
-                        .getSchema()
-                        .arguments();
-
-        // Two Cases in terms of number of argument required and argument
-        // provided
-        // Case 1 (n_required < n_provided) we ignore the extra provided args,
-        // respecting Js convention
-        // Case 2 (n_required >= n_provided) we process the provided argument
-        // and let libtorch check if they are enough, this would handle module
-        // with default parameters
-        int argCount = std::min(count, args.size() - 1);
-
-        std::vector<torch_::jit::IValue> input = {};
-        for (int i = 0; i < argCount; i++) {
-          c10::DynamicType& dynType =
-              args[i + 1].type()->expectRef<c10::DynamicType>();
-          input.push_back(utils::converter::jsiValuetoIValue(
-              runtime, arguments[i], dynType));
-        }
-        return std::make_tuple(thiz->mobileModule, input);
+        return std::make_tuple(
+            plan->pool,
+            convertArguments(runtime, *plan, arguments, count),
+            plan->outputOptions->mode);
       },
 
-      [&, functionName](MethodAsyncTask::SetupResultType&& setupResult)
-          -> torch_::jit::IValue {
-        torch_::jit::mobile::Module mobileModule;
+      [plan](MethodAsyncTask::SetupResultType&& setupResult) -> MethodOutput {
+        std::shared_ptr<ModulePool> pool;
         std::vector<torch_::jit::IValue> inputs;
-        std::tie(mobileModule, inputs) = setupResult;
-        c10::InferenceMode guard;
-        return mobileModule.get_method(functionName)(inputs);
+        OutputMode mode;
+        std::tie(pool, inputs, mode) = std::move(setupResult);
+        // Runs on the replica that the work was posted with, or, for sync
+        // calls, waits for a free replica if the pool size is limited.
+        return prepareOutput(
+            mode, pool->run(plan->function, std::move(inputs)));
       },
 
       [](jsi::Runtime& runtime,
          torchlive::RuntimeExecutor,
-         torch_::jit::IValue&& value) -> jsi::Value {
-        return utils::converter::ivalueToJSIValue(runtime, value);
-      });
+         MethodOutput&& output) -> jsi::Value {
+        return convertOutput(runtime, std::move(output));
+      },
+
+      ThreadPool::Priority::kInteractive,
+      std::move(scheduleFunc));
 }
+
+using ProfileAsyncTask = common::AsyncTask<
+    std::tuple<
+        std::shared_ptr<const MethodPlan>,
+        std::vector<torch_::jit::IValue>,
+        std::string>,
+    std::tuple<torch_::jit::IValue, std::vector<OpEvent>>>;
+
+jsi::Array shapesToJSIArray(
+    jsi::Runtime& runtime,
+    const std::vector<std::vector<int64_t>>& shapes) {
+  auto result = jsi::Array(runtime, shapes.size());
+  for (size_t i = 0; i < shapes.size(); i++) {
+    auto shape = jsi::Array(runtime, shapes[i].size());
+    for (size_t j = 0; j < shapes[i].size(); j++) {
+      shape.setValueAtIndex(runtime, j, static_cast<double>(shapes[i][j]));
+    }
+    result.setValueAtIndex(runtime, i, std::move(shape));
+  }
+  return result;
+}
+
 } // namespace
 
 ModuleHostObject::ModuleHostObject(
@@ -104,45 +288,576 @@ ModuleHostObject::ModuleHostObject(
     torch_::jit::mobile::Module m)
     : BaseHostObject(rt),
       mobileModule(std::move(m)),
-      runtimeExecutor(std::move(rte)) {
-  methodAsyncTasks.emplace(
-      "forward", createMethodAsyncTask(mobileModule, "forward"));
+      runtimeExecutor(std::move(rte)),
+      modulePool(std::make_shared<ModulePool>(mobileModule)),
+      outputOptions(std::make_shared<OutputOptions>()) {
+  // forward and forwardSync are resolved on first access like other methods
+  // (see get), so modules without a forward method can be loaded.
+  setPropertyHostFunction(rt, "setLatestWins", 2, setLatestWinsImpl);
+  setPropertyHostFunction(rt, "setReplicas", 1, setReplicasImpl);
+  setPropertyHostFunction(rt, "getReplicaStats", 0, getReplicaStatsImpl);
+  setPropertyHostFunction(rt, "setBatching", 2, setBatchingImpl);
+  setPropertyHostFunction(rt, "getBatchStats", 1, getBatchStatsImpl);
+  setPropertyHostFunction(rt, "setNumThreads", 1, setNumThreadsImpl);
+  setPropertyHostFunction(rt, "getNumThreads", 0, getNumThreadsImpl);
+  setPropertyHostFunction(rt, "setOutputMode", 1, setOutputModeImpl);
   setPropertyHostFunction(
-      rt, "forward", 1, methodAsyncTasks.at("forward").asyncPromiseFunc(rte));
+      rt, "setCachingAllocator", 1, setCachingAllocatorImpl);
+  setPropertyHostFunction(rt, "trimMemory", 0, trimMemoryImpl);
+  setPropertyHostFunction(rt, "getAllocatorStats", 0, getAllocatorStatsImpl);
   setPropertyHostFunction(
-      rt, "forwardSync", 1, methodAsyncTasks.at("forward").syncFunc(rte));
+      rt, "profile", 2, createProfileFunction(runtimeExecutor));
+}
+
+ModuleHostObject::ModuleHostObject(
+    jsi::Runtime& rt,
+    torchlive::RuntimeExecutor rte,
+    std::shared_ptr<const ModelRegistry::Model> model)
+    : ModuleHostObject(rt, std::move(rte), model->module) {
+  registryModel = std::move(model);
+}
+
+ModuleHostObject::~ModuleHostObject() {
+  if (registryModel != nullptr) {
+    ModelRegistry::instance().release(std::move(registryModel));
+  }
+}
+
+void ModuleHostObject::setLoadStats(
+    jsi::Runtime& runtime,
+    double loadTime,
+    double autotuneTime,
+    double warmupTime,
+    const std::string& autotuneCacheError) {
+  jsi::Object loadStats(runtime);
+  loadStats.setProperty(runtime, "loadTime", loadTime);
+  loadStats.setProperty(runtime, "autotuneTime", autotuneTime);
+  loadStats.setProperty(runtime, "warmupTime", warmupTime);
+  if (!autotuneCacheError.empty()) {
+    loadStats.setProperty(
+        runtime,
+        "autotuneCacheError",
+        jsi::String::createFromUtf8(runtime, autotuneCacheError));
+  }
+  propertyMap_.erase("loadStats");
+  setProperty(runtime, "loadStats", std::move(loadStats));
+}
+
+void ModuleHostObject::setNumThreads(std::size_t threads) {
+  modulePool->setNumThreads(threads);
+}
+
+std::shared_ptr<const MethodPlan> ModuleHostObject::getMethodPlan(
+    const std::string& methodName) {
+  auto it = methodPlans.find(methodName);
+  if (it == methodPlans.end()) {
+    it = methodPlans
+             .emplace(
+                 methodName,
+                 createMethodPlan(
+                     mobileModule, modulePool, outputOptions, methodName))
+             .first;
+  }
+  return it->second;
+}
+
+const MethodAsyncTask& ModuleHostObject::getMethodAsyncTask(
+    const std::string& methodName) {
+  auto it = methodAsyncTasks.find(methodName);
+  if (it == methodAsyncTasks.end()) {
+    it = methodAsyncTasks
+             .emplace(
+                 methodName, createMethodAsyncTask(getMethodPlan(methodName)))
+             .first;
+  }
+  return it->second;
+}
+
+jsi::Value ModuleHostObject::setLatestWinsImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  utils::ArgumentParser args(runtime, thisValue, arguments, count);
+  args.requireNumArguments(2);
+  auto thiz = args.thisAsHostObject<ModuleHostObject>();
+  auto methodName = args[0].asString(runtime).utf8(runtime);
+  if (!args[1].isBool()) {
+    throw jsi::JSError(
+        runtime, "expect 'enabled' to be boolean, but another type is given.");
+  }
+  if (!args[1].getBool()) {
+    thiz->latestWinsMethods.erase(methodName);
+    return jsi::Value::undefined();
+  }
+  if (thiz->mobileModule.find_method(methodName) == c10::nullopt) {
+    throw jsi::JSError(runtime, "module has no method named " + methodName);
+  }
+  if (thiz->latestWinsMethods.count(methodName) > 0) {
+    return jsi::Value::undefined();
+  }
+
+  auto queue = std::make_shared<LatestWinsQueue>(thiz->runtimeExecutor);
+  auto promiseFunc =
+      createMethodAsyncTask(
+          thiz->getMethodPlan(methodName),
+          [queue](
+              const MethodAsyncTask::SetupResultType& setupResult,
+              std::function<void()> work,
+              ThreadPool::Priority priority) {
+            // The schedule function runs in the Scope of the call.
+            queue->schedule(
+                std::get<0>(setupResult),
+                std::move(work),
+                priority,
+                common::CancellationToken::current());
+          })
+          .asyncPromiseFunc(thiz->runtimeExecutor);
+  auto function = jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forUtf8(runtime, methodName),
+      1,
+      [promiseFunc](
+          jsi::Runtime& runtime,
+          const jsi::Value& thisValue,
+          const jsi::Value* arguments,
+          size_t count) {
+        // Each call has a token, which the queue cancels when a newer call
+        // replaces it.
+        common::CancellationToken::Scope scope(
+            std::make_shared<common::CancellationToken>(
+                "superseded by a newer call",
+                common::CancellationToken::current()));
+        return promiseFunc(runtime, thisValue, arguments, count);
+      });
+  thiz->latestWinsMethods.emplace(
+      methodName, LatestWinsMethod{std::move(function)});
+  return jsi::Value::undefined();
+}
+
+jsi::Value ModuleHostObject::setReplicasImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  utils::ArgumentParser args(runtime, thisValue, arguments, count);
+  args.requireNumArguments(1);
+  auto thiz = args.thisAsHostObject<ModuleHostObject>();
+  auto replicas = args[0].asNumber();
+  if (replicas < 0 || replicas != static_cast<size_t>(replicas)) {
+    throw jsi::JSError(runtime, "expect replicas to be a non-negative integer");
+  }
+  thiz->modulePool->resize(static_cast<size_t>(replicas));
+  return jsi::Value::undefined();
+}
+
+jsi::Value ModuleHostObject::getReplicaStatsImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  utils::ArgumentParser args(runtime, thisValue, arguments, count);
+  auto thiz = args.thisAsHostObject<ModuleHostObject>();
+  auto stats = thiz->modulePool->stats();
+  auto replicas = jsi::Array(runtime, stats.replicas.size());
+  for (size_t i = 0; i < stats.replicas.size(); i++) {
+    const auto& replicaStats = stats.replicas[i];
+    jsi::Object replica(runtime);
+    replica.setProperty(
+        runtime, "calls", static_cast<double>(replicaStats.calls));
+    replica.setProperty(
+        runtime, "busyTime", replicaStats.busyTime.count() / 1000.0);
+    replica.setProperty(runtime, "utilization", replicaStats.utilization);
+    replicas.setValueAtIndex(runtime, i, std::move(replica));
+  }
+
+  jsi::Object result(runtime);
+  result.setProperty(runtime, "replicas", std::move(replicas));
+  result.setProperty(runtime, "queued", static_cast<double>(stats.queued));
+  return result;
 }
+
+jsi::Value ModuleHostObject::setBatchingImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  utils::ArgumentParser args(runtime, thisValue, arguments, count);
+  args.requireNumArguments(2);
+  auto thiz = args.thisAsHostObject<ModuleHostObject>();
+  auto methodName = args[0].asString(runtime).utf8(runtime);
+  // Pending calls of a replaced batcher still run.
+  thiz->batchedMethods.erase(methodName);
+  if (args[1].isNull() || args[1].isUndefined()) {
+    return jsi::Value::undefined();
+  }
+  if (thiz->mobileModule.find_method(methodName) == c10::nullopt) {
+    throw jsi::JSError(runtime, "module has no method named " + methodName);
+  }
+
+  MethodBatcher::Options options;
+  auto maxBatchSizeValue = args.keywordValue(1, "maxBatchSize");
+  auto maxBatchSize =
+      maxBatchSizeValue.isUndefined() ? 8 : maxBatchSizeValue.asNumber();
+  if (maxBatchSize < 1 || maxBatchSize != std::floor(maxBatchSize)) {
+    throw jsi::JSError(runtime, "expect maxBatchSize to be a positive integer");
+  }
+  // The batcher keeps a histogram entry per batch size, so the size is
+  // clamped before it is converted.
+  options.maxBatchSize = static_cast<size_t>(std::min(
+      maxBatchSize, static_cast<double>(MethodBatcher::kMaxBatchSize)));
+  auto maxDelayValue = args.keywordValue(1, "maxDelay");
+  auto maxDelay = maxDelayValue.isUndefined() ? 5 : maxDelayValue.asNumber();
+  if (maxDelay < 0) {
+    throw jsi::JSError(runtime, "expect maxDelay to be a non-negative number");
+  }
+  options.maxDelay =
+      std::chrono::microseconds(static_cast<int64_t>(maxDelay * 1000));
+
+  auto plan = thiz->getMethodPlan(methodName);
+  auto batcher =
+      std::make_shared<MethodBatcher>(plan->pool, plan->function, options);
+  auto runtimeExecutor = thiz->runtimeExecutor;
+  auto function = jsi::Function::createFromHostFunction(
+      runtime,
+      jsi::PropNameID::forUtf8(runtime, methodName),
+      1,
+      [plan, batcher, runtimeExecutor](
+          jsi::Runtime& runtime,
+          const jsi::Value& thisValue,
+          const jsi::Value* arguments,
+          size_t count) {
+        return createPromiseAsJSIValue(
+            runtime,
+            [&](jsi::Runtime& rt, std::shared_ptr<Promise> promise) {
+              auto inputs = convertArguments(rt, *plan, arguments, count);
+              auto mode = plan->outputOptions->mode;
+              batcher->submit(
+                  std::move(inputs),
+                  [mode, promise, runtimeExecutor](
+                      c10::IValue value, std::exception_ptr error) {
+                    MethodOutput output;
+                    if (error == nullptr) {
+                      try {
+                        output = prepareOutput(mode, std::move(value));
+                      } catch (...) {
+                        error = std::current_exception();
+                      }
+                    }
+                    runtimeExecutor([promise,
+                                     output = std::move(output),
+                                     error](jsi::Runtime& rt) mutable {
+                      if (error == nullptr) {
+                        promise->resolve(convertOutput(rt, std::move(output)));
+                        return;
+                      }
+                      try {
+                        std::rethrow_exception(error);
+                      } catch (std::exception& e) {
+                        promise->reject(e.what());
+                      }
+                    });
+                  });
+            });
+      });
+  thiz->batchedMethods.emplace(
+      methodName, BatchedMethod{std::move(function), std::move(batcher)});
+  return jsi::Value::undefined();
+}
+
+jsi::Value ModuleHostObject::getBatchStatsImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  utils::ArgumentParser args(runtime, thisValue, arguments, count);
+  args.requireNumArguments(1);
+  auto thiz = args.thisAsHostObject<ModuleHostObject>();
+  auto methodName = args[0].asString(runtime).utf8(runtime);
+  auto it = thiz->batchedMethods.find(methodName);
+  if (it == thiz->batchedMethods.end()) {
+    return jsi::Value::undefined();
+  }
+  auto batchSizes = it->second.batcher->batchSizes();
+  auto histogram = jsi::Array(runtime, batchSizes.size());
+  for (size_t i = 0; i < batchSizes.size(); i++) {
+    histogram.setValueAtIndex(runtime, i, static_cast<double>(batchSizes[i]));
+  }
+  jsi::Object result(runtime);
+  result.setProperty(runtime, "batchSizes", std::move(histogram));
+  return result;
+}
+
+jsi::Value ModuleHostObject::setNumThreadsImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  utils::ArgumentParser args(runtime, thisValue, arguments, count);
+  args.requireNumArguments(1);
+  auto thiz = args.thisAsHostObject<ModuleHostObject>();
+  auto threads = args[0].asNumber();
+  if (threads < 0 || threads != static_cast<size_t>(threads)) {
+    throw jsi::JSError(runtime, "expect threads to be a non-negative integer");
+  }
+  thiz->setNumThreads(static_cast<size_t>(threads));
+  return jsi::Value::undefined();
+}
+
+jsi::Value ModuleHostObject::getNumThreadsImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  utils::ArgumentParser args(runtime, thisValue, arguments, count);
+  auto thiz = args.thisAsHostObject<ModuleHostObject>();
+  auto threads = thiz->modulePool->numThreads();
+  return static_cast<double>(
+      threads > 0 ? threads : defaultIntraOpThreads());
+}
+
+jsi::Value ModuleHostObject::setOutputModeImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  utils::ArgumentParser args(runtime, thisValue, arguments, count);
+  args.requireNumArguments(1);
+  auto thiz = args.thisAsHostObject<ModuleHostObject>();
+  auto mode = args[0].asString(runtime).utf8(runtime);
+  if (mode == "eager") {
+    thiz->outputOptions->mode = OutputMode::kEager;
+  } else if (mode == "lazy") {
+    thiz->outputOptions->mode = OutputMode::kLazy;
+  } else if (mode == "typedArrays") {
+    thiz->outputOptions->mode = OutputMode::kTypedArrays;
+  } else if (mode == "raw") {
+    thiz->outputOptions->mode = OutputMode::kRaw;
+  } else {
+    throw jsi::JSError(
+        runtime,
+        "expect output mode to be 'eager', 'lazy', 'typedArrays' or 'raw', "
+        "but got " +
+            mode);
+  }
+  return jsi::Value::undefined();
+}
+
+jsi::Value ModuleHostObject::setCachingAllocatorImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  utils::ArgumentParser args(runtime, thisValue, arguments, count);
+  args.requireNumArguments(1);
+  auto thiz = args.thisAsHostObject<ModuleHostObject>();
+  if (!args[0].isBool()) {
+    throw jsi::JSError(runtime, "expect enabled to be a boolean");
+  }
+  auto enabled = args[0].getBool();
+  auto allocator = thiz->modulePool->cachingAllocator();
+  if (enabled && allocator == nullptr) {
+    thiz->modulePool->setCachingAllocator(std::make_shared<CachingAllocator>());
+  } else if (!enabled && allocator != nullptr) {
+    thiz->modulePool->setCachingAllocator(nullptr);
+  }
+  return jsi::Value::undefined();
+}
+
+jsi::Value ModuleHostObject::trimMemoryImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  utils::ArgumentParser args(runtime, thisValue, arguments, count);
+  auto thiz = args.thisAsHostObject<ModuleHostObject>();
+  auto allocator = thiz->modulePool->cachingAllocator();
+  if (allocator != nullptr) {
+    allocator->trim();
+  }
+  return jsi::Value::undefined();
+}
+
+jsi::Value ModuleHostObject::getAllocatorStatsImpl(
+    jsi::Runtime& runtime,
+    const jsi::Value& thisValue,
+    const jsi::Value* arguments,
+    size_t count) {
+  utils::ArgumentParser args(runtime, thisValue, arguments, count);
+  auto thiz = args.thisAsHostObject<ModuleHostObject>();
+  auto allocator = thiz->modulePool->cachingAllocator();
+  if (allocator == nullptr) {
+    return jsi::Value::undefined();
+  }
+  auto stats = allocator->stats();
+  jsi::Object result(runtime);
+  result.setProperty(
+      runtime, "cachedBytes", static_cast<double>(stats.cachedBytes));
+  result.setProperty(
+      runtime, "allocations", static_cast<double>(stats.allocations));
+  result.setProperty(runtime, "hits", static_cast<double>(stats.hits));
+  result.setProperty(
+      runtime,
+      "hitRate",
+      stats.allocations > 0
+          ? static_cast<double>(stats.hits) / stats.allocations
+          : 0.0);
+  return result;
+}
+
+jsi::HostFunctionType ModuleHostObject::createProfileFunction(
+    torchlive::RuntimeExecutor runtimeExecutor) {
+  return ProfileAsyncTask::createPromiseFunction(
+      std::move(runtimeExecutor),
+      [](jsi::Runtime& runtime,
+         const jsi::Value& thisValue,
+         const jsi::Value* arguments,
+         size_t count) -> ProfileAsyncTask::SetupResultType {
+        utils::ArgumentParser args(runtime, thisValue, arguments, count);
+        args.requireNumArguments(2);
+        auto thiz = args.thisAsHostObject<ModuleHostObject>();
+        auto methodName = args[0].asString(runtime).utf8(runtime);
+        if (thiz->mobileModule.find_method(methodName) == c10::nullopt) {
+          throw jsi::JSError(
+              runtime, "module has no method named " + methodName);
+        }
+        auto plan = thiz->getMethodPlan(methodName);
+
+        auto inputsArray = args[1].asObject(runtime).asArray(runtime);
+        std::vector<jsi::Value> inputValues;
+        for (size_t i = 0; i < inputsArray.size(runtime); i++) {
+          inputValues.push_back(inputsArray.getValueAtIndex(runtime, i));
+        }
+        auto inputs = convertArguments(
+            runtime, *plan, inputValues.data(), inputValues.size());
+
+        std::string tracePath;
+        auto tracePathValue = args.keywordValue(2, "tracePath");
+        if (tracePathValue.isString()) {
+          tracePath = tracePathValue.asString(runtime).utf8(runtime);
+        } else if (!tracePathValue.isUndefined()) {
+          throw jsi::JSError(
+              runtime,
+              "expect 'tracePath' to be a string, but another type is given.");
+        }
+        return std::make_tuple(
+            std::move(plan), std::move(inputs), std::move(tracePath));
+      },
+
+      [](ProfileAsyncTask::SetupResultType&& setupResult)
+          -> ProfileAsyncTask::WorkResultType {
+        std::shared_ptr<const MethodPlan> plan;
+        std::vector<torch_::jit::IValue> inputs;
+        std::string tracePath;
+        std::tie(plan, inputs, tracePath) = std::move(setupResult);
+
+        OpProfiler profiler;
+        auto output = plan->pool->run(plan->function, std::move(inputs));
+        auto events = profiler.stop();
+        if (!tracePath.empty()) {
+          filesystem::writeFile(tracePath, OpProfiler::toChromeTrace(events));
+        }
+        return std::make_tuple(std::move(output), std::move(events));
+      },
+
+      [](jsi::Runtime& runtime,
+         torchlive::RuntimeExecutor,
+         ProfileAsyncTask::WorkResultType&& workResult) -> jsi::Value {
+        torch_::jit::IValue output;
+        std::vector<OpEvent> events;
+        std::tie(output, events) = std::move(workResult);
+
+        auto eventArray = jsi::Array(runtime, events.size());
+        for (size_t i = 0; i < events.size(); i++) {
+          const auto& event = events[i];
+          jsi::Object eventObject(runtime);
+          eventObject.setProperty(
+              runtime,
+              "name",
+              jsi::String::createFromUtf8(runtime, event.name));
+          eventObject.setProperty(
+              runtime, "start", event.start.count() / 1000.0);
+          eventObject.setProperty(
+              runtime, "duration", event.duration.count() / 1000.0);
+          eventObject.setProperty(runtime, "depth", event.depth);
+          eventObject.setProperty(
+              runtime, "shapes", shapesToJSIArray(runtime, event.shapes));
+          eventObject.setProperty(
+              runtime,
+              "allocatedBytes",
+              static_cast<double>(event.allocatedBytes));
+          eventObject.setProperty(
+              runtime, "freedBytes", static_cast<double>(event.freedBytes));
+          eventArray.setValueAtIndex(runtime, i, std::move(eventObject));
+        }
+
+        jsi::Object result(runtime);
+        result.setProperty(
+            runtime,
+            "output",
+            utils::converter::ivalueToJSIValue(runtime, output));
+        result.setProperty(runtime, "events", std::move(eventArray));
+        return result;
+      },
+
+      ThreadPool::Priority::kInteractive,
+
+      [](const ProfileAsyncTask::SetupResultType& setupResult,
+         std::function<void()> work,
+         ThreadPool::Priority priority) {
+        std::get<0>(setupResult)->pool->post(std::move(work), priority);
+      });
+}
+
+std::vector<jsi::PropNameID> ModuleHostObject::getPropertyNames(
+    jsi::Runtime& runtime) {
+  auto result = BaseHostObject::getPropertyNames(runtime);
+  if (mobileModule.find_method("forward") != c10::nullopt) {
+    result.push_back(jsi::PropNameID::forAscii(runtime, "forward"));
+    result.push_back(jsi::PropNameID::forAscii(runtime, "forwardSync"));
+  }
+  return result;
+}
+
 jsi::Value ModuleHostObject::get(
     jsi::Runtime& runtime,
     const jsi::PropNameID& name) {
   const auto& propName = name.utf8(runtime);
-  const auto& syncPrefix = getSyncMethodPrefix(propName);
-  auto member = BaseHostObject::get(runtime, name);
+  auto latestWinsIt = latestWinsMethods.find(propName);
+  if (latestWinsIt != latestWinsMethods.end()) {
+    return jsi::Value(runtime, latestWinsIt->second.function);
+  }
+  auto batchedIt = batchedMethods.find(propName);
+  if (batchedIt != batchedMethods.end()) {
+    return jsi::Value(runtime, batchedIt->second.function);
+  }
+  auto functionIt = methodFunctions.find(propName);
+  if (functionIt != methodFunctions.end()) {
+    return jsi::Value(runtime, functionIt->second);
+  }
+  auto member = BaseHostObject::get(runtime, name, propName);
   if (!member.isUndefined()) {
     return member;
-  } else if (mobileModule.find_method(propName) != c10::nullopt) {
-    methodAsyncTasks.emplace(
-        propName, createMethodAsyncTask(mobileModule, propName));
-    return jsi::Function::createFromHostFunction(
-        runtime,
-        name,
-        1,
-        methodAsyncTasks.at(propName).asyncPromiseFunc(runtimeExecutor));
+  }
+
+  jsi::HostFunctionType func;
+  const auto& syncPrefix = getSyncMethodPrefix(propName);
+  if (mobileModule.find_method(propName) != c10::nullopt) {
+    func = getMethodAsyncTask(propName).asyncPromiseFunc(runtimeExecutor);
   } else if (
       // if method with name "*Sync" is looked for, return the "sync version"
       // of the module method, where * can't be empty.
       !syncPrefix.empty() &&
       mobileModule.find_method(syncPrefix) != c10::nullopt) {
-    methodAsyncTasks.emplace(
-        syncPrefix, createMethodAsyncTask(mobileModule, syncPrefix));
-    return jsi::Function::createFromHostFunction(
-        runtime,
-        name,
-        1,
-        methodAsyncTasks.at(syncPrefix).syncFunc(runtimeExecutor));
+    func = getMethodAsyncTask(syncPrefix).syncFunc(runtimeExecutor);
   } else {
     return member;
   }
+  auto function =
+      jsi::Function::createFromHostFunction(runtime, name, 1, std::move(func));
+  auto result = jsi::Value(runtime, function);
+  methodFunctions.emplace(propName, std::move(function));
+  return result;
 }
 
 } // namespace mobile
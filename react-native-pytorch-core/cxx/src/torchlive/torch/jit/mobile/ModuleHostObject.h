@@ -11,9 +11,19 @@
 
 #include <torch/csrc/jit/mobile/module.h>
 
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "../../../common/AsyncTask.h"
 #include "../../../common/BaseHostObject.h"
+#include "../../../common/CancellationToken.h"
 #include "../../../torchlive.h"
+#include "../../utils/StagedValue.h"
+#include "MethodBatcher.h"
+#include "ModelRegistry.h"
+#include "ModulePool.h"
 
 // Namespace alias for torch to avoid namespace conflicts with torchlive::torch
 namespace torch_ = torch;
@@ -23,9 +33,45 @@ namespace torch {
 namespace jit {
 namespace mobile {
 
+// How the outputs of method calls are converted to JavaScript values.
+enum class OutputMode {
+  // Converts the whole output like utils::converter::ivalueToJSIValue. The
+  // output is staged on the worker thread, see utils::converter::StagedValue.
+  kEager,
+  // Converts dicts, lists and tuples on property access, see
+  // utils::converter::ivalueToLazyJSIValue.
+  kLazy,
+  // Same as kEager, but lists of floats and ints become Float64Arrays.
+  kTypedArrays,
+  // Returns the output as IValueHostObject without converting it, which can
+  // be passed to methods of other modules as it is.
+  kRaw,
+};
+
+// Output options of a module, shared by its methods. They are only accessed
+// on the JavaScript thread.
+struct OutputOptions {
+  OutputMode mode = OutputMode::kEager;
+};
+
+// A module method resolved for calls from JavaScript.
+struct MethodPlan;
+
+// The output of a method call, prepared for conversion on the worker thread.
+struct MethodOutput {
+  OutputMode mode = OutputMode::kEager;
+  // The output of kLazy and kRaw calls.
+  torch_::jit::IValue value;
+  // The output of other calls.
+  utils::converter::StagedValue staged;
+};
+
 using MethodAsyncTask = common::AsyncTask<
-    std::tuple<torch_::jit::mobile::Module, std::vector<torch_::jit::IValue>>,
-    torch_::jit::IValue>;
+    std::tuple<
+        std::shared_ptr<ModulePool>,
+        std::vector<torch_::jit::IValue>,
+        OutputMode>,
+    MethodOutput>;
 
 class JSI_EXPORT ModuleHostObject : public common::BaseHostObject {
  public:
@@ -33,12 +79,138 @@ class JSI_EXPORT ModuleHostObject : public common::BaseHostObject {
       facebook::jsi::Runtime& runtime,
       torchlive::RuntimeExecutor runtimeExecutor,
       torch_::jit::mobile::Module m);
+  // Creates a module host object for a model of the ModelRegistry. The model
+  // is released to the registry when the host object is destroyed.
+  explicit ModuleHostObject(
+      facebook::jsi::Runtime& runtime,
+      torchlive::RuntimeExecutor runtimeExecutor,
+      std::shared_ptr<const ModelRegistry::Model> model);
+  ~ModuleHostObject();
+
+  // Exposes the time in milliseconds it took to load the model, to tune its
+  // thread count and to warm it up as module.loadStats, and why the tuned
+  // thread count couldn't be stored, if it couldn't.
+  void setLoadStats(
+      facebook::jsi::Runtime& runtime,
+      double loadTime,
+      double autotuneTime,
+      double warmupTime,
+      const std::string& autotuneCacheError = "");
+
+  // Sets the intra-op thread count of method calls, or 0 to use the default
+  // thread count.
+  void setNumThreads(std::size_t threads);
+
   jsi::Value get(jsi::Runtime& rt, const jsi::PropNameID& name) override;
+  // Includes forward and forwardSync if the module has a forward method.
+  std::vector<jsi::PropNameID> getPropertyNames(jsi::Runtime& rt) override;
   torch_::jit::mobile::Module mobileModule;
 
  private:
+  // State of a method in latest-wins mode, see setLatestWins.
+  struct LatestWinsMethod {
+    // The function returned for the method name, which runs one call at a
+    // time and keeps the newest call waiting.
+    jsi::Function function;
+  };
+
+  // State of a method with batching enabled, see setBatching.
+  struct BatchedMethod {
+    // The function returned for the method name.
+    jsi::Function function;
+    std::shared_ptr<MethodBatcher> batcher;
+  };
+
+  // Returns the method and its argument types, resolving them on first use.
+  std::shared_ptr<const MethodPlan> getMethodPlan(
+      const std::string& methodName);
+
+  // Returns the task that calls the method, creating it on first use.
+  const MethodAsyncTask& getMethodAsyncTask(const std::string& methodName);
+
+  static jsi::Value setLatestWinsImpl(
+      jsi::Runtime& runtime,
+      const jsi::Value& thisValue,
+      const jsi::Value* arguments,
+      size_t count);
+
+  static jsi::Value setReplicasImpl(
+      jsi::Runtime& runtime,
+      const jsi::Value& thisValue,
+      const jsi::Value* arguments,
+      size_t count);
+
+  static jsi::Value getReplicaStatsImpl(
+      jsi::Runtime& runtime,
+      const jsi::Value& thisValue,
+      const jsi::Value* arguments,
+      size_t count);
+
+  static jsi::Value setBatchingImpl(
+      jsi::Runtime& runtime,
+      const jsi::Value& thisValue,
+      const jsi::Value* arguments,
+      size_t count);
+
+  static jsi::Value setNumThreadsImpl(
+      jsi::Runtime& runtime,
+      const jsi::Value& thisValue,
+      const jsi::Value* arguments,
+      size_t count);
+
+  static jsi::Value getNumThreadsImpl(
+      jsi::Runtime& runtime,
+      const jsi::Value& thisValue,
+      const jsi::Value* arguments,
+      size_t count);
+
+  static jsi::Value setOutputModeImpl(
+      jsi::Runtime& runtime,
+      const jsi::Value& thisValue,
+      const jsi::Value* arguments,
+      size_t count);
+
+  static jsi::Value setCachingAllocatorImpl(
+      jsi::Runtime& runtime,
+      const jsi::Value& thisValue,
+      const jsi::Value* arguments,
+      size_t count);
+
+  static jsi::Value trimMemoryImpl(
+      jsi::Runtime& runtime,
+      const jsi::Value& thisValue,
+      const jsi::Value* arguments,
+      size_t count);
+
+  static jsi::Value getAllocatorStatsImpl(
+      jsi::Runtime& runtime,
+      const jsi::Value& thisValue,
+      const jsi::Value* arguments,
+      size_t count);
+
+  // Creates the profile function, which runs a method with the OpProfiler.
+  static jsi::HostFunctionType createProfileFunction(
+      torchlive::RuntimeExecutor runtimeExecutor);
+
+  static jsi::Value getBatchStatsImpl(
+      jsi::Runtime& runtime,
+      const jsi::Value& thisValue,
+      const jsi::Value* arguments,
+      size_t count);
+
   torchlive::RuntimeExecutor runtimeExecutor;
+  std::shared_ptr<const ModelRegistry::Model> registryModel;
+  // The replicas that method calls run on, see setReplicas.
+  std::shared_ptr<ModulePool> modulePool;
+  std::shared_ptr<OutputOptions> outputOptions;
+  std::unordered_map<std::string, std::shared_ptr<const MethodPlan>>
+      methodPlans = {};
   std::unordered_map<std::string, MethodAsyncTask> methodAsyncTasks = {};
+  // Functions of the methods found on property access by property name, e.g.,
+  // "detect" and "detectSync", so repeated accesses return the same function.
+  std::unordered_map<std::string, jsi::Function> methodFunctions = {};
+  std::unordered_map<std::string, LatestWinsMethod> latestWinsMethods = {};
+  std::unordered_map<std::string, BatchedMethod> batchedMethods = {};
 };
 
 } // namespace mobile
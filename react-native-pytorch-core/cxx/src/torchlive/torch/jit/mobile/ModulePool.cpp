@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <c10/util/Optional.h>
+
+#include <algorithm>
+#include <future>
+#include <utility>
+
+#include "IntraOpThreads.h"
+#include "ModulePool.h"
+
+namespace torchlive {
+namespace torch {
+namespace jit {
+namespace mobile {
+
+namespace {
+
+// The pool and the lease of the task that the current thread runs, see
+// ModulePool::post.
+thread_local const ModulePool* currentPool = nullptr;
+thread_local ModulePool::Lease* currentLease = nullptr;
+
+// Sets the pool and the lease of the current thread while it is alive.
+class CurrentLeaseScope {
+ public:
+  CurrentLeaseScope(const ModulePool* pool, ModulePool::Lease* lease)
+      : previousPool_(currentPool), previousLease_(currentLease) {
+    currentPool = pool;
+    currentLease = lease;
+  }
+
+  ~CurrentLeaseScope() {
+    currentPool = previousPool_;
+    currentLease = previousLease_;
+  }
+
+  CurrentLeaseScope(const CurrentLeaseScope&) = delete;
+  CurrentLeaseScope& operator=(const CurrentLeaseScope&) = delete;
+
+ private:
+  const ModulePool* previousPool_;
+  ModulePool::Lease* previousLease_;
+};
+
+// Copies the module object and its submodule objects. The copies reference the
+// same tensors, so the weights are not copied.
+c10::intrusive_ptr<c10::ivalue::Object> replicateObject(
+    const c10::intrusive_ptr<c10::ivalue::Object>& object) {
+  auto copy = object->copy();
+  for (size_t i = 0; i < copy->slots().size(); i++) {
+    const auto& slot = copy->getSlot(i);
+    if (slot.isObject()) {
+      copy->setSlot(i, replicateObject(slot.toObject()));
+    }
+  }
+  return copy;
+}
+
+// Returns a module with a copy of the module object, see replicateObject.
+torch_::jit::mobile::Module replicateModule(
+    const torch_::jit::mobile::Module& module) {
+  // The module doesn't expose its compilation unit pointer, so the replica
+  // references it through a copy of the module, which keeps it alive.
+  auto owner = std::make_shared<torch_::jit::mobile::Module>(module);
+  std::shared_ptr<torch_::jit::mobile::CompilationUnit> compilationUnit(
+      owner,
+      const_cast<torch_::jit::mobile::CompilationUnit*>(
+          &owner->compilation_unit()));
+  return torch_::jit::mobile::Module(
+      replicateObject(module._ivalue()), std::move(compilationUnit));
+}
+
+} // namespace
+
+ModulePool::Lease::Lease(
+    std::shared_ptr<ModulePool> pool,
+    std::shared_ptr<Replica> replica,
+    torch_::jit::mobile::Module module)
+    : pool_(std::move(pool)),
+      replica_(std::move(replica)),
+      module_(std::move(module)) {}
+
+ModulePool::Lease::~Lease() {
+  if (pool_ != nullptr && replica_ != nullptr) {
+    pool_->checkin(replica_);
+  }
+}
+
+ModulePool::ModulePool(torch_::jit::mobile::Module module)
+    : module_(std::move(module)) {}
+
+void ModulePool::resize(std::size_t size) {
+  std::vector<std::pair<Grant, Lease>> served;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (size < replicas_.size()) {
+      replicas_.resize(size);
+    }
+    auto now = Clock::now();
+    while (replicas_.size() < size) {
+      auto replica = std::make_shared<Replica>();
+      // The first replica is the module itself.
+      replica->module = replicas_.empty() ? module_ : replicateModule(module_);
+      replica->created = now;
+      replicas_.push_back(std::move(replica));
+    }
+    served = serveWaiting();
+  }
+  for (auto& grant : served) {
+    grant.first(std::move(grant.second));
+  }
+}
+
+std::size_t ModulePool::size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return replicas_.size();
+}
+
+ModulePool::Lease ModulePool::checkout() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (waiting_.empty()) {
+      if (replicas_.empty()) {
+        return lease(nullptr);
+      }
+      for (const auto& replica : replicas_) {
+        if (!replica->busy) {
+          return lease(replica);
+        }
+      }
+    }
+  }
+
+  auto promise = std::make_shared<std::promise<Lease>>();
+  auto future = promise->get_future();
+  request([promise](Lease&& lease) { promise->set_value(std::move(lease)); });
+  return future.get();
+}
+
+void ModulePool::post(
+    std::function<void()> task,
+    ThreadPool::Priority priority) {
+  auto pool = shared_from_this();
+  request([pool, task = std::move(task), priority](Lease&& lease) {
+    auto sharedLease = std::make_shared<Lease>(std::move(lease));
+    ThreadPool::pool()->run(
+        [pool, task, sharedLease]() {
+          {
+            CurrentLeaseScope scope(pool.get(), sharedLease.get());
+            task();
+          }
+          // Check the replica in before the thread picks up other work.
+          Lease released = std::move(*sharedLease);
+        },
+        priority);
+  });
+}
+
+void ModulePool::setCachingAllocator(
+    std::shared_ptr<CachingAllocator> allocator) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  cachingAllocator_ = std::move(allocator);
+}
+
+std::shared_ptr<CachingAllocator> ModulePool::cachingAllocator() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cachingAllocator_;
+}
+
+void ModulePool::setNumThreads(std::size_t threads) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  numThreads_ = threads;
+}
+
+std::size_t ModulePool::numThreads() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return numThreads_;
+}
+
+c10::IValue ModulePool::run(
+    torch_::jit::mobile::Function* function,
+    std::vector<c10::IValue> inputs) {
+  c10::optional<Lease> checkedOut;
+  auto lease = currentPool == this ? currentLease : nullptr;
+  if (lease == nullptr) {
+    checkedOut.emplace(checkout());
+    lease = &*checkedOut;
+  }
+
+  std::shared_ptr<CachingAllocator> allocator;
+  std::size_t threads;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    allocator = cachingAllocator_;
+    threads = numThreads_;
+  }
+  c10::optional<CachingAllocator::Guard> allocatorGuard;
+  if (allocator != nullptr) {
+    allocatorGuard.emplace(*allocator);
+  }
+  IntraOpThreadsCall threadsCall(threads);
+  c10::InferenceMode guard;
+  return torch_::jit::mobile::Method(&lease->module(), function)(
+      std::move(inputs));
+}
+
+void ModulePool::request(Grant grant) {
+  std::vector<std::pair<Grant, Lease>> served;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    waiting_.push_back(std::move(grant));
+    served = serveWaiting();
+  }
+  for (auto& waiting : served) {
+    waiting.first(std::move(waiting.second));
+  }
+}
+
+void ModulePool::checkin(const std::shared_ptr<Replica>& replica) {
+  std::vector<std::pair<Grant, Lease>> served;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    replica->busy = false;
+    replica->busyTime += Clock::now() - replica->checkedOut;
+    served = serveWaiting();
+  }
+  for (auto& waiting : served) {
+    waiting.first(std::move(waiting.second));
+  }
+}
+
+std::vector<std::pair<ModulePool::Grant, ModulePool::Lease>>
+ModulePool::serveWaiting() {
+  std::vector<std::pair<Grant, Lease>> served;
+  if (replicas_.empty()) {
+    // Without replicas, there is no limit.
+    while (!waiting_.empty()) {
+      served.emplace_back(std::move(waiting_.front()), lease(nullptr));
+      waiting_.pop_front();
+    }
+    return served;
+  }
+  // Replicas removed by resize are not in replicas_, so they aren't reused.
+  for (const auto& replica : replicas_) {
+    if (waiting_.empty()) {
+      break;
+    }
+    if (!replica->busy) {
+      served.emplace_back(std::move(waiting_.front()), lease(replica));
+      waiting_.pop_front();
+    }
+  }
+  return served;
+}
+
+ModulePool::Lease ModulePool::lease(const std::shared_ptr<Replica>& replica) {
+  if (replica == nullptr) {
+    return Lease(shared_from_this(), nullptr, module_);
+  }
+  replica->busy = true;
+  replica->calls++;
+  replica->checkedOut = Clock::now();
+  return Lease(shared_from_this(), replica, replica->module);
+}
+
+ModulePool::Stats ModulePool::stats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats result;
+  result.queued = waiting_.size();
+  auto now = Clock::now();
+  for (const auto& replica : replicas_) {
+    // Count the time of a running call up to now.
+    auto busyTime = replica->busyTime +
+        (replica->busy ? now - replica->checkedOut : Clock::duration::zero());
+    auto lifetime = now - replica->created;
+    result.replicas.push_back(
+        {replica->calls,
+         std::chrono::duration_cast<std::chrono::microseconds>(busyTime),
+         lifetime.count() > 0
+             ? static_cast<double>(busyTime.count()) / lifetime.count()
+             : 0.0});
+  }
+  return result;
+}
+
+} // namespace mobile
+} // namespace jit
+} // namespace torch
+} // namespace torchlive
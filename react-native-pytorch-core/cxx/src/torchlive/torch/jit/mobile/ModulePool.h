@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+// Suppress deprecated-declarations error to support Clang/C++17
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#include <torch/csrc/jit/mobile/module.h>
+#pragma clang diagnostic pop
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "../../../ThreadPool.h"
+#include "CachingAllocator.h"
+
+// Namespace alias for torch to avoid namespace conflicts with torchlive::torch
+namespace torch_ = torch;
+
+namespace torchlive {
+namespace torch {
+namespace jit {
+namespace mobile {
+
+// A pool of replicas of a module, which bounds how many calls run on the
+// module at once. Replicas share the weights and other tensors of the module,
+// but have their own module objects, so attributes a method sets on a replica
+// are not visible to calls on other replicas.
+//
+// With a size of 0 (the default), there are no replicas and all calls run on
+// the module itself without a limit.
+//
+// The intra-op threads are a process-wide pool (see IntraOpThreads.h), which
+// calls only resize to the thread count of the module while no other call
+// runs, e.g., on other replicas.
+class ModulePool : public std::enable_shared_from_this<ModulePool> {
+ private:
+  struct Replica;
+
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // A replica checked out of the pool. It is checked back in when the lease is
+  // destroyed.
+  class Lease {
+   public:
+    Lease(Lease&& other) = default;
+    Lease& operator=(Lease&& other) = default;
+    ~Lease();
+
+    torch_::jit::mobile::Module& module() noexcept {
+      return module_;
+    }
+
+   private:
+    friend class ModulePool;
+
+    Lease(
+        std::shared_ptr<ModulePool> pool,
+        std::shared_ptr<Replica> replica,
+        torch_::jit::mobile::Module module);
+
+    std::shared_ptr<ModulePool> pool_;
+    std::shared_ptr<Replica> replica_;
+    torch_::jit::mobile::Module module_;
+  };
+
+  struct ReplicaStats {
+    std::uint64_t calls;
+    std::chrono::microseconds busyTime;
+    // The fraction of time the replica was busy since it was created.
+    double utilization;
+  };
+
+  struct Stats {
+    std::vector<ReplicaStats> replicas;
+    // The number of calls waiting for a replica.
+    std::size_t queued;
+  };
+
+  explicit ModulePool(torch_::jit::mobile::Module module);
+
+  // Sets the number of replicas. Calls running on removed replicas finish
+  // normally.
+  void resize(std::size_t size);
+
+  std::size_t size();
+
+  // Returns a free replica, blocking the calling thread until one is free if
+  // all replicas are busy. Waiting calls are served in order, together with
+  // the tasks waiting in post.
+  Lease checkout();
+
+  // Runs the task on a ThreadPool thread once a replica is free. While all
+  // replicas are busy, the task waits in the pool without holding a thread,
+  // and is posted when a replica is checked in. Calls of run within the task
+  // use that replica.
+  void post(std::function<void()> task, ThreadPool::Priority priority);
+
+  // Sets the allocator that calls of run allocate their tensors with, or
+  // nullptr to use the default allocator.
+  void setCachingAllocator(std::shared_ptr<CachingAllocator> allocator);
+
+  std::shared_ptr<CachingAllocator> cachingAllocator();
+
+  // Sets the intra-op thread count of calls of run, or 0 to use the default
+  // thread count, see IntraOpThreadsCall.
+  void setNumThreads(std::size_t threads);
+
+  std::size_t numThreads();
+
+  // Returns the module that the replicas are copied from.
+  const torch_::jit::mobile::Module& module() const noexcept {
+    return module_;
+  }
+
+  // Runs the function of the module on the replica of the current task (see
+  // post), or else on a free replica, see checkout.
+  c10::IValue run(
+      torch_::jit::mobile::Function* function,
+      std::vector<c10::IValue> inputs);
+
+  Stats stats();
+
+ private:
+  struct Replica {
+    torch_::jit::mobile::Module module;
+    bool busy = false;
+    std::uint64_t calls = 0;
+    Clock::duration busyTime = Clock::duration::zero();
+    Clock::time_point created;
+    Clock::time_point checkedOut;
+  };
+
+  // Receives the lease of a waiting call or task.
+  using Grant = std::function<void(Lease&&)>;
+
+  // Checks out a free replica for the grant, or queues the grant until a
+  // replica is free.
+  void request(Grant grant);
+
+  void checkin(const std::shared_ptr<Replica>& replica);
+
+  // Checks out free replicas for the waiting grants, which must be called
+  // with the leases after mutex_ is released. Must be called with mutex_
+  // held.
+  std::vector<std::pair<Grant, Lease>> serveWaiting();
+
+  Lease lease(const std::shared_ptr<Replica>& replica);
+
+  torch_::jit::mobile::Module module_;
+  std::mutex mutex_;
+  std::vector<std::shared_ptr<Replica>> replicas_;
+  std::shared_ptr<CachingAllocator> cachingAllocator_;
+  std::size_t numThreads_ = 0;
+  // Waiting calls and tasks, in order.
+  std::deque<Grant> waiting_;
+};
+
+} // namespace mobile
+} // namespace jit
+} // namespace torch
+} // namespace torchlive
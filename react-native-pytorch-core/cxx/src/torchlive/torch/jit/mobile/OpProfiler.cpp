@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <c10/core/Allocator.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <utility>
+
+#include "OpProfiler.h"
+
+namespace torchlive {
+namespace torch {
+namespace jit {
+namespace mobile {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+
+// The profiler recording on this thread, if any.
+thread_local OpProfiler* currentProfiler = nullptr;
+
+struct OpContext : public at::ObserverContext {
+  explicit OpContext(size_t eventIndex) : eventIndex(eventIndex) {}
+
+  size_t eventIndex;
+};
+
+void writeJSONString(std::ostringstream& stream, const std::string& value) {
+  stream << '"';
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      stream << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[8];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      stream << escaped;
+    } else {
+      stream << c;
+    }
+  }
+  stream << '"';
+}
+
+} // namespace
+
+// Attributes CPU memory allocations to the innermost running operator call.
+// The allocator reports allocations to the PROFILER_STATE debug info of the
+// allocating thread.
+class OpProfiler::MemoryReporter : public c10::MemoryReportingInfoBase {
+ public:
+  explicit MemoryReporter(OpProfiler* profiler) : profiler_(profiler) {}
+
+  void reportMemoryUsage(
+      void* ptr,
+      int64_t allocSize,
+      int64_t totalAllocated,
+      int64_t totalReserved,
+      c10::Device device) override {
+    if (device.is_cpu()) {
+      profiler_->reportMemory(allocSize);
+    }
+  }
+
+  bool memoryProfilingEnabled() const override {
+    return true;
+  }
+
+ private:
+  OpProfiler* profiler_;
+};
+
+OpProfiler::OpProfiler()
+    : start_(Clock::now()),
+      memoryReporter_(std::make_shared<MemoryReporter>(this)),
+      previous_(currentProfiler) {
+  currentProfiler = this;
+  callbackHandle_ = at::addThreadLocalCallback(
+      at::RecordFunctionCallback(&OpProfiler::onEnter, &OpProfiler::onExit)
+          .needsInputs(true)
+          .scopes(
+              {at::RecordScope::FUNCTION, at::RecordScope::LITE_INTERPRETER}));
+  memoryReporterGuard_ = std::make_unique<c10::DebugInfoGuard>(
+      c10::DebugInfoKind::PROFILER_STATE, memoryReporter_);
+}
+
+OpProfiler::~OpProfiler() {
+  stop();
+}
+
+std::vector<OpEvent> OpProfiler::stop() {
+  if (callbackHandle_ != 0) {
+    at::removeCallback(callbackHandle_);
+    callbackHandle_ = 0;
+    memoryReporterGuard_.reset();
+    currentProfiler = previous_;
+  }
+  return std::move(events_);
+}
+
+std::unique_ptr<at::ObserverContext> OpProfiler::onEnter(
+    const at::RecordFunction& fn) {
+  auto profiler = currentProfiler;
+  if (profiler == nullptr) {
+    return nullptr;
+  }
+  OpEvent event;
+  event.name = fn.name();
+  event.start = duration_cast<microseconds>(Clock::now() - profiler->start_);
+  event.duration = microseconds::zero();
+  event.depth = static_cast<int>(profiler->running_.size());
+  for (const auto& input : fn.inputs()) {
+    if (input.isTensor()) {
+      event.shapes.push_back(input.toTensor().sizes().vec());
+    } else {
+      event.shapes.emplace_back();
+    }
+  }
+  event.allocatedBytes = 0;
+  event.freedBytes = 0;
+
+  auto eventIndex = profiler->events_.size();
+  profiler->events_.push_back(std::move(event));
+  profiler->running_.push_back(eventIndex);
+  return std::make_unique<OpContext>(eventIndex);
+}
+
+void OpProfiler::onExit(
+    const at::RecordFunction& fn,
+    at::ObserverContext* ctx) {
+  auto profiler = currentProfiler;
+  if (profiler == nullptr || ctx == nullptr) {
+    return;
+  }
+  auto eventIndex = static_cast<OpContext*>(ctx)->eventIndex;
+  auto& event = profiler->events_[eventIndex];
+  event.duration =
+      duration_cast<microseconds>(Clock::now() - profiler->start_) -
+      event.start;
+  auto& running = profiler->running_;
+  running.erase(
+      std::remove(running.begin(), running.end(), eventIndex), running.end());
+}
+
+void OpProfiler::reportMemory(int64_t bytes) {
+  if (running_.empty()) {
+    return;
+  }
+  auto& event = events_[running_.back()];
+  if (bytes > 0) {
+    event.allocatedBytes += bytes;
+  } else {
+    event.freedBytes -= bytes;
+  }
+}
+
+std::string OpProfiler::toChromeTrace(const std::vector<OpEvent>& events) {
+  std::ostringstream stream;
+  stream << "{\"traceEvents\":[";
+  for (size_t i = 0; i < events.size(); i++) {
+    const auto& event = events[i];
+    if (i > 0) {
+      stream << ',';
+    }
+    stream << "{\"name\":";
+    writeJSONString(stream, event.name);
+    stream << ",\"ph\":\"X\",\"pid\":0,\"tid\":0"
+           << ",\"ts\":" << event.start.count()
+           << ",\"dur\":" << event.duration.count()
+           << ",\"args\":{\"shapes\":[";
+    for (size_t j = 0; j < event.shapes.size(); j++) {
+      stream << (j > 0 ? ",[" : "[");
+      for (size_t k = 0; k < event.shapes[j].size(); k++) {
+        stream << (k > 0 ? "," : "") << event.shapes[j][k];
+      }
+      stream << ']';
+    }
+    stream << "],\"allocatedBytes\":" << event.allocatedBytes
+           << ",\"freedBytes\":" << event.freedBytes << "}}";
+  }
+  stream << "],\"displayTimeUnit\":\"ms\"}";
+  return stream.str();
+}
+
+} // namespace mobile
+} // namespace jit
+} // namespace torch
+} // namespace torchlive
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <ATen/record_function.h>
+#include <c10/util/ThreadLocalDebugInfo.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace torchlive {
+namespace torch {
+namespace jit {
+namespace mobile {
+
+// An operator call recorded by the OpProfiler.
+struct OpEvent {
+  std::string name;
+  // Start time relative to the start of profiling.
+  std::chrono::microseconds start;
+  std::chrono::microseconds duration;
+  // The number of enclosing operator calls, e.g., 1 for an ATen function
+  // called by an interpreter instruction.
+  int depth;
+  // Sizes of the tensor inputs, empty for other inputs.
+  std::vector<std::vector<int64_t>> shapes;
+  // Memory allocated and freed on the CPU while the operator ran, excluding
+  // nested operator calls.
+  int64_t allocatedBytes;
+  int64_t freedBytes;
+};
+
+// Records the operator calls on the current thread while it is alive, with
+// their timings, input shapes and memory use. This uses RecordFunction
+// callbacks, which are available in all PyTorch mobile builds, unlike the
+// Kineto based edge profiler.
+class OpProfiler {
+ public:
+  OpProfiler();
+  ~OpProfiler();
+
+  OpProfiler(const OpProfiler&) = delete;
+  OpProfiler& operator=(const OpProfiler&) = delete;
+
+  // Stops recording and returns the recorded events in start order.
+  std::vector<OpEvent> stop();
+
+  // Returns the events in the Chrome trace event format, which can be opened
+  // in chrome://tracing or Perfetto.
+  static std::string toChromeTrace(const std::vector<OpEvent>& events);
+
+ private:
+  class MemoryReporter;
+
+  static std::unique_ptr<at::ObserverContext> onEnter(
+      const at::RecordFunction& fn);
+  static void onExit(const at::RecordFunction& fn, at::ObserverContext* ctx);
+
+  void reportMemory(int64_t bytes);
+
+  std::chrono::steady_clock::time_point start_;
+  std::vector<OpEvent> events_;
+  // Indices of the events of running operator calls, innermost last.
+  std::vector<size_t> running_;
+  at::CallbackHandle callbackHandle_ = 0;
+  std::shared_ptr<MemoryReporter> memoryReporter_;
+  std::unique_ptr<c10::DebugInfoGuard> memoryReporterGuard_;
+  OpProfiler* previous_;
+};
+
+} // namespace mobile
+} // namespace jit
+} // namespace torch
+} // namespace torchlive
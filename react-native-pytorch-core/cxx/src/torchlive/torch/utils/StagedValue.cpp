@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cstring>
+#include <stdexcept>
+
+#include "../TensorHostObject.h"
+#include "StagedValue.h"
+#include "helpers.h"
+
+using namespace facebook;
+
+namespace torchlive {
+namespace utils {
+namespace converter {
+
+namespace {
+
+using Kind = StagedValue::Kind;
+
+// Returns the property name of a dict key, like ivalueToJSIValue.
+std::string objectKey(const at::IValue& ivalue) {
+  if (ivalue.isString()) {
+    return ivalue.toStringRef();
+  } else if (ivalue.isDouble()) {
+    return std::to_string(ivalue.toDouble());
+  } else if (ivalue.isInt()) {
+    return std::to_string(ivalue.toInt());
+  }
+  throw std::runtime_error(ivalue.tagKind() + " can't convert to object key.");
+}
+
+void addNode(StagedValue& staged, Kind kind, size_t index, size_t size) {
+  staged.nodes.push_back(
+      {kind, static_cast<uint32_t>(index), static_cast<uint32_t>(size)});
+}
+
+void addNumber(StagedValue& staged, Kind kind, double number) {
+  addNode(staged, kind, staged.numbers.size(), 0);
+  staged.numbers.push_back(number);
+}
+
+void stage(StagedValue& staged, const at::IValue& ivalue) {
+  if (ivalue.isNone()) {
+    addNode(staged, Kind::kNull, 0, 0);
+  } else if (ivalue.isTensor()) {
+    addNode(staged, Kind::kTensor, staged.tensors.size(), 0);
+    staged.tensors.push_back(ivalue.toTensor());
+  } else if (ivalue.isDouble()) {
+    addNumber(staged, Kind::kNumber, ivalue.toDouble());
+  } else if (ivalue.isInt()) {
+    // ivalueToJSIValue converts ints to 32-bit ints.
+    addNumber(staged, Kind::kNumber, static_cast<int>(ivalue.toInt()));
+  } else if (ivalue.isBool()) {
+    addNumber(staged, Kind::kBool, ivalue.toBool() ? 1 : 0);
+  } else if (ivalue.isString()) {
+    addNode(staged, Kind::kString, staged.strings.size(), 0);
+    staged.strings.push_back(ivalue.toStringRef());
+  } else if (ivalue.isGenericDict()) {
+    const auto& dict = ivalue.toGenericDict();
+    // The property names are added before the values, which may add strings
+    // of their own.
+    addNode(staged, Kind::kObject, staged.strings.size(), dict.size());
+    for (const auto& entry : dict) {
+      staged.strings.push_back(objectKey(entry.key()));
+    }
+    for (const auto& entry : dict) {
+      stage(staged, entry.value());
+    }
+  } else if (ivalue.isDoubleList()) {
+    auto list = ivalue.toDoubleList();
+    addNode(staged, Kind::kNumberList, staged.numbers.size(), list.size());
+    for (double value : list) {
+      staged.numbers.push_back(value);
+    }
+  } else if (ivalue.isIntList()) {
+    auto list = ivalue.toIntList();
+    addNode(staged, Kind::kNumberList, staged.numbers.size(), list.size());
+    for (int64_t value : list) {
+      // Like single ints, unless the list becomes a Float64Array, which holds
+      // ints up to 2^53 exactly.
+      staged.numbers.push_back(
+          staged.typedArrays ? static_cast<double>(value)
+                             : static_cast<int>(value));
+    }
+  } else if (ivalue.isList()) {
+    const auto& list = ivalue.toListRef();
+    addNode(staged, Kind::kArray, 0, list.size());
+    for (const auto& element : list) {
+      stage(staged, element);
+    }
+  } else if (ivalue.isTuple()) {
+    const auto& elements = ivalue.toTupleRef().elements();
+    addNode(staged, Kind::kArray, 0, elements.size());
+    for (const auto& element : elements) {
+      stage(staged, element);
+    }
+  } else {
+    throw std::runtime_error(
+        ivalue.tagKind() + " can't convert to jsi::Value.");
+  }
+}
+
+jsi::Value createFloat64Array(
+    jsi::Runtime& runtime,
+    const double* numbers,
+    size_t size) {
+  auto byteLength = size * sizeof(double);
+  auto buffer = runtime.global()
+                    .getPropertyAsFunction(runtime, "ArrayBuffer")
+                    .callAsConstructor(runtime, static_cast<double>(byteLength))
+                    .asObject(runtime)
+                    .getArrayBuffer(runtime);
+  if (byteLength > 0) {
+    std::memcpy(buffer.data(runtime), numbers, byteLength);
+  }
+  return runtime.global()
+      .getPropertyAsFunction(runtime, "Float64Array")
+      .callAsConstructor(runtime, buffer);
+}
+
+// Creates the JavaScript values of the nodes in depth-first order.
+class Materializer {
+ public:
+  Materializer(jsi::Runtime& runtime, StagedValue& staged)
+      : runtime_(runtime), staged_(staged) {}
+
+  jsi::Value next() {
+    const auto node = staged_.nodes.at(nextNode_++);
+    switch (node.kind) {
+      case Kind::kNull:
+        return jsi::Value::null();
+      case Kind::kBool:
+        return jsi::Value(staged_.numbers[node.index] != 0);
+      case Kind::kNumber:
+        return jsi::Value(staged_.numbers[node.index]);
+      case Kind::kString:
+        return jsi::String::createFromUtf8(
+            runtime_, staged_.strings[node.index]);
+      case Kind::kTensor:
+        return helpers::createFromHostObject<torch::TensorHostObject>(
+            runtime_, std::move(staged_.tensors[node.index]));
+      case Kind::kObject: {
+        auto object = jsi::Object(runtime_);
+        for (uint32_t i = 0; i < node.size; i++) {
+          object.setProperty(
+              runtime_,
+              jsi::PropNameID::forUtf8(
+                  runtime_, staged_.strings[node.index + i]),
+              next());
+        }
+        return object;
+      }
+      case Kind::kArray: {
+        auto array = jsi::Array(runtime_, node.size);
+        for (uint32_t i = 0; i < node.size; i++) {
+          array.setValueAtIndex(runtime_, i, next());
+        }
+        return array;
+      }
+      case Kind::kNumberList: {
+        const double* numbers = staged_.numbers.data() + node.index;
+        if (staged_.typedArrays) {
+          return createFloat64Array(runtime_, numbers, node.size);
+        }
+        auto array = jsi::Array(runtime_, node.size);
+        for (uint32_t i = 0; i < node.size; i++) {
+          array.setValueAtIndex(runtime_, i, numbers[i]);
+        }
+        return array;
+      }
+    }
+    throw jsi::JSError(runtime_, "invalid staged value");
+  }
+
+ private:
+  jsi::Runtime& runtime_;
+  StagedValue& staged_;
+  size_t nextNode_ = 0;
+};
+
+} // namespace
+
+StagedValue stageIValue(const at::IValue& ivalue, bool typedArrays) {
+  StagedValue staged;
+  staged.typedArrays = typedArrays;
+  stage(staged, ivalue);
+  return staged;
+}
+
+jsi::Value stagedValueToJSIValue(jsi::Runtime& runtime, StagedValue&& staged) {
+  return Materializer(runtime, staged).next();
+}
+
+} // namespace converter
+} // namespace utils
+} // namespace torchlive
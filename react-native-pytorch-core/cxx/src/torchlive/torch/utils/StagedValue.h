@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <jsi/jsi.h>
+
+// Suppress deprecated-declarations error to support Clang/C++17
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#include <torch/script.h>
+#pragma clang diagnostic pop
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace torchlive {
+namespace utils {
+namespace converter {
+
+/**
+ * An IValue flattened into packed buffers, so that converting it to a
+ * jsi::Value on the JavaScript thread only creates the JavaScript values. The
+ * IValue tree is walked, strings are encoded and numeric lists are packed on
+ * the thread that stages the value, e.g., a worker thread.
+ */
+struct StagedValue {
+  enum class Kind : uint8_t {
+    kNull,
+    kBool,
+    kNumber,
+    kString,
+    kTensor,
+    // A JavaScript object with a property per dict entry.
+    kObject,
+    // A JavaScript array of the elements of a list or tuple.
+    kArray,
+    // A list of floats or ints packed into numbers.
+    kNumberList,
+  };
+
+  struct Node {
+    Kind kind;
+    // The index of the value in numbers, strings or tensors. For kObject
+    // nodes, the index of the first property name in strings, and for
+    // kNumberList nodes, the index of the first number.
+    uint32_t index;
+    // The number of properties, elements or numbers of a container.
+    uint32_t size;
+  };
+
+  // The nodes in depth-first order, where each kObject and kArray node is
+  // followed by the nodes of its properties or elements.
+  std::vector<Node> nodes;
+  std::vector<double> numbers;
+  std::vector<std::string> strings;
+  std::vector<at::Tensor> tensors;
+  // Whether kNumberList nodes become Float64Arrays instead of arrays.
+  bool typedArrays = false;
+};
+
+/**
+ * Flattens the IValue into a StagedValue. The result converts to the same
+ * jsi::Value as ivalueToJSIValue, except that numeric lists are converted to
+ * Float64Arrays with typedArrays. Can be called on any thread, and throws
+ * std::runtime_error for values that can't be converted.
+ */
+StagedValue stageIValue(const at::IValue& ivalue, bool typedArrays);
+
+/**
+ * Creates the JavaScript value of a StagedValue.
+ */
+facebook::jsi::Value stagedValueToJSIValue(
+    facebook::jsi::Runtime& runtime,
+    StagedValue&& staged);
+
+} // namespace converter
+} // namespace utils
+} // namespace torchlive
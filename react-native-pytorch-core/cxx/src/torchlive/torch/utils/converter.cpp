@@ -13,6 +13,9 @@
 
 #include <cmath>
 
+#include "../DictHostObject.h"
+#include "../IValueHostObject.h"
+#include "../LazyValueHostObject.h"
 #include "../TensorHostObject.h"
 #include "converter.h"
 #include "helpers.h"
@@ -25,6 +28,22 @@ namespace converter {
 
 namespace {
 
+// Returns the IValue of a host object that wraps a native value, e.g., a
+// model output in raw or lazy output mode.
+c10::optional<at::IValue> nativeIValue(
+    jsi::Runtime& runtime,
+    const jsi::Object& object) {
+  if (object.isHostObject<torch::IValueHostObject>(runtime)) {
+    return object.getHostObject<torch::IValueHostObject>(runtime)->value;
+  } else if (object.isHostObject<torch::LazyValueHostObject>(runtime)) {
+    return object.getHostObject<torch::LazyValueHostObject>(runtime)->value;
+  } else if (object.isHostObject<torch::DictHostObject>(runtime)) {
+    return at::IValue(
+        object.getHostObject<torch::DictHostObject>(runtime)->dict());
+  }
+  return c10::nullopt;
+}
+
 std::string ivalueToObjectKey(jsi::Runtime& runtime, const at::IValue& ivalue) {
   if (ivalue.isString()) {
     return ivalue.toString()->string();
@@ -115,6 +134,16 @@ jsi::Value ivalueToJSIValue(jsi::Runtime& runtime, const at::IValue& ivalue) {
       runtime, ivalue.tagKind() + " can't convert to jsi::Value.");
 }
 
+jsi::Value ivalueToLazyJSIValue(
+    jsi::Runtime& runtime,
+    const at::IValue& ivalue) {
+  if (ivalue.isGenericDict() || ivalue.isList() || ivalue.isTuple()) {
+    return utils::helpers::createFromHostObject<torch::LazyValueHostObject>(
+        runtime, ivalue);
+  }
+  return ivalueToJSIValue(runtime, ivalue);
+}
+
 /**
  * A helper method to pack a JSValue object into an IValue
  */
@@ -124,6 +153,21 @@ torch_::jit::IValue jsiValuetoIValue(
     const c10::DynamicType& dynamicType) {
   torch_::jit::IValue iValue;
   auto kind = dynamicType.dynamicKind();
+  // Native values are passed through as they are, so outputs of one model
+  // can be passed to another model without converting them to JavaScript
+  // values and back. Their types are checked against the schema like the
+  // types of JavaScript values.
+  if (jsValue.isObject()) {
+    auto native = nativeIValue(runtime, jsValue.getObject(runtime));
+    if (native.has_value()) {
+      auto nativeType = native->type();
+      if (!nativeType->isSubtypeOf(dynamicType)) {
+        throwUnexpectedTypeError(
+            runtime, c10::typeKindToString(kind), nativeType->str());
+      }
+      return *native;
+    }
+  }
   switch (kind) {
     case c10::TypeKind::IntType: {
       auto n = jsValue.asNumber();
@@ -164,6 +208,29 @@ torch_::jit::IValue jsiValuetoIValue(
       return tensorHostObject->tensor;
     }
     case c10::TypeKind::ListType: {
+      auto& childType =
+          dynamicType.containedType(0)->expectRef<c10::DynamicType>();
+      auto childKind = childType.dynamicKind();
+      if (childKind == c10::TypeKind::FloatType ||
+          childKind == c10::TypeKind::IntType) {
+        // Fast path for List[float] and List[int] given as a TypedArray or
+        // ArrayBuffer, which converts all elements in bulk.
+        auto tensor = helpers::parseTypedArray(runtime, jsValue);
+        if (tensor.defined()) {
+          if (childKind == c10::TypeKind::FloatType) {
+            auto doubles = tensor.to(torch_::kFloat64);
+            return c10::List<double>(c10::ArrayRef<double>(
+                doubles.data_ptr<double>(), doubles.numel()));
+          }
+          if (tensor.is_floating_point()) {
+            throwUnexpectedTypeError(
+                runtime, c10::typeKindToString(childKind), "a float");
+          }
+          auto ints = tensor.to(torch_::kInt64);
+          return c10::List<int64_t>(c10::ArrayRef<int64_t>(
+              ints.data_ptr<int64_t>(), ints.numel()));
+        }
+      }
       if (!jsValue.isObject()) {
         throwUnexpectedTypeError(
             runtime,
@@ -173,8 +240,6 @@ torch_::jit::IValue jsiValuetoIValue(
         throwUnexpectedTypeError(
             runtime, c10::typeKindToString(kind), "unknown object");
       }
-      auto& childType =
-          dynamicType.containedType(0)->expectRef<c10::DynamicType>();
       auto jsArray = jsValue.asObject(runtime).asArray(runtime);
       auto length = jsArray.length(runtime);
       c10::impl::GenericList list =
@@ -29,6 +29,14 @@ facebook::jsi::Value ivalueToJSIValue(
     facebook::jsi::Runtime& runtime,
     const at::IValue&);
 
+/**
+ * Same as ivalueToJSIValue, but dicts, lists and tuples are wrapped in
+ * LazyValueHostObjects, which convert their elements on property access.
+ */
+facebook::jsi::Value ivalueToLazyJSIValue(
+    facebook::jsi::Runtime& runtime,
+    const at::IValue& ivalue);
+
 /*
  * A helper method used to pack a jsi::Value to an IValue
  */
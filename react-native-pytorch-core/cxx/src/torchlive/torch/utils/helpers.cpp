@@ -5,6 +5,8 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <cmath>
+
 #include "helpers.h"
 #include "constants.h"
 
@@ -70,6 +72,9 @@ torchlive::torch::TensorHostObject* parseTensor(
   if (tensorHostObject == nullptr) {
     throw jsi::JSError(runtime, "Value must be a tensor");
   }
+  if (tensorHostObject->isDisposed()) {
+    throw jsi::JSError(runtime, "Tensor is disposed");
+  }
   return tensorHostObject;
 }
 
@@ -206,6 +211,77 @@ std::vector<int64_t> parseJSIArrayShape(
   return shape;
 }
 
+torch_::Tensor parseTypedArray(jsi::Runtime& runtime, const jsi::Value& val) {
+  if (!val.isObject()) {
+    return torch_::Tensor();
+  }
+  auto obj = val.asObject(runtime);
+  if (obj.isArrayBuffer(runtime)) {
+    auto buffer = obj.getArrayBuffer(runtime);
+    int64_t size = buffer.size(runtime);
+    return torch_::from_blob(buffer.data(runtime), {size}, torch_::kUInt8)
+        .clone();
+  }
+  if (obj.isArray(runtime) || obj.isFunction(runtime) ||
+      obj.isHostObject(runtime)) {
+    return torch_::Tensor();
+  }
+
+  auto bufferValue = obj.getProperty(runtime, "buffer");
+  if (!bufferValue.isObject() ||
+      !bufferValue.asObject(runtime).isArrayBuffer(runtime)) {
+    return torch_::Tensor();
+  }
+
+  auto typedArrayName = obj.getProperty(runtime, "constructor")
+                            .asObject(runtime)
+                            .getProperty(runtime, "name")
+                            .asString(runtime)
+                            .utf8(runtime);
+  torch_::Dtype dtype;
+  if (typedArrayName == "Uint8Array" || typedArrayName == "Uint8ClampedArray") {
+    dtype = torch_::kUInt8;
+  } else if (typedArrayName == "Int8Array") {
+    dtype = torch_::kInt8;
+  } else if (typedArrayName == "Int16Array") {
+    dtype = torch_::kInt16;
+  } else if (typedArrayName == "Int32Array") {
+    dtype = torch_::kInt32;
+  } else if (typedArrayName == "Float32Array") {
+    dtype = torch_::kFloat32;
+  } else if (typedArrayName == "Float64Array") {
+    dtype = torch_::kFloat64;
+  } else {
+    throw jsi::JSError(
+        runtime, typedArrayName + " is not supported as tensor data");
+  }
+
+  // The properties are read from the object, which isn't necessarily a
+  // TypedArray, so the range they describe is checked against the buffer.
+  auto parseIndex = [&](const char* name) {
+    auto value = obj.getProperty(runtime, name);
+    double number = value.isNumber() ? value.asNumber() : -1;
+    if (!std::isfinite(number) || number < 0 || std::fmod(number, 1) != 0) {
+      throw jsi::JSError(
+          runtime,
+          typedArrayName + " " + name + " must be a non-negative integer");
+    }
+    return number;
+  };
+  auto buffer = bufferValue.asObject(runtime).getArrayBuffer(runtime);
+  double byteOffset = parseIndex("byteOffset");
+  double length = parseIndex("length");
+  if (byteOffset + length * c10::elementSize(dtype) > buffer.size(runtime)) {
+    throw jsi::JSError(
+        runtime, typedArrayName + " range exceeds the size of its buffer");
+  }
+  return torch_::from_blob(
+             buffer.data(runtime) + static_cast<size_t>(byteOffset),
+             {static_cast<int64_t>(length)},
+             torch_::TensorOptions().dtype(dtype))
+      .clone();
+}
+
 void setPropertyHostFunction(
     jsi::Runtime& runtime,
     jsi::Object& obj,
@@ -15,6 +15,7 @@
 #include <torch/script.h>
 #pragma clang diagnostic pop
 
+#include "../../common/BaseHostObject.h"
 #include "../TensorHostObject.h"
 
 namespace torchlive {
@@ -89,6 +90,16 @@ std::vector<int64_t> parseJSIArrayShape(
     facebook::jsi::Runtime& runtime,
     const facebook::jsi::Value& val);
 
+/**
+ * A helper method to copy the data of a TypedArray (e.g., Float32Array) or
+ * ArrayBuffer into a one-dimensional tensor of the matching dtype with a single
+ * bulk copy. Returns an undefined tensor if the value is neither a TypedArray
+ * nor an ArrayBuffer.
+ */
+torch_::Tensor parseTypedArray(
+    facebook::jsi::Runtime& runtime,
+    const facebook::jsi::Value& val);
+
 /**
  * A helper method to assign a HostFunction to an Object property.
  * The paramCount parameter specifies the function.length property in JSI
@@ -101,17 +112,34 @@ void setPropertyHostFunction(
     size_t paramCount,
     facebook::jsi::HostFunctionType hostFunc);
 
+// Reports the native memory of a host object, which is only held by host
+// objects that derive from common::BaseHostObject.
+inline void reportExternalMemory(
+    facebook::jsi::Runtime&,
+    const facebook::jsi::Object&,
+    facebook::jsi::HostObject&) {}
+
+inline void reportExternalMemory(
+    facebook::jsi::Runtime& runtime,
+    const facebook::jsi::Object& object,
+    common::BaseHostObject& hostObject) {
+  hostObject.reportExternalMemory(runtime, object);
+}
+
 /**
  * A helper method for the common pattern of creating and wrapping a HostObject
- * instance to return as a jsi::Value.
+ * instance to return as a jsi::Value. The native memory held by the host
+ * object is reported to the garbage collector.
  */
 template <typename T, typename... Args>
 inline facebook::jsi::Object createFromHostObject(
     facebook::jsi::Runtime& runtime,
     Args&&... args) {
   auto hostObject = std::make_shared<T>(runtime, std::forward<Args>(args)...);
-  return facebook::jsi::Object::createFromHostObject(
-      runtime, std::move(hostObject));
+  auto object =
+      facebook::jsi::Object::createFromHostObject(runtime, hostObject);
+  reportExternalMemory(runtime, object, *hostObject);
+  return object;
 }
 
 // adapt from
@@ -7,6 +7,11 @@
 
 #include <jsi/jsi.h>
 
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "common/CompletionQueue.h"
 #include "experimental/ExperimentalNamespace.h"
 #include "filesystem/FilesystemNamespace.h"
 #include "media/MediaNamespace.h"
@@ -19,7 +24,69 @@ namespace torchlive {
 
 using namespace facebook;
 
+namespace {
+
+std::mutex completionQueuesMutex;
+std::unordered_map<jsi::Runtime*, std::shared_ptr<common::CompletionQueue>>
+    completionQueues;
+
+// Removes the completion queue of a runtime when the runtime is torn down,
+// which finalizes all host objects. A new runtime may get the address of the
+// torn down runtime, so its entry must not outlive it. The entry is only
+// removed if it wasn't replaced by installing the bindings again.
+class CompletionQueueAnchor : public jsi::HostObject {
+ public:
+  CompletionQueueAnchor(
+      jsi::Runtime& runtime,
+      std::shared_ptr<common::CompletionQueue> completionQueue)
+      : runtime_(&runtime), completionQueue_(std::move(completionQueue)) {}
+
+  ~CompletionQueueAnchor() override {
+    std::lock_guard<std::mutex> lock(completionQueuesMutex);
+    auto it = completionQueues.find(runtime_);
+    if (it != completionQueues.end() && it->second == completionQueue_) {
+      completionQueues.erase(it);
+    }
+  }
+
+ private:
+  // Only used as the key, the runtime may already be destroyed.
+  jsi::Runtime* runtime_;
+  std::shared_ptr<common::CompletionQueue> completionQueue_;
+};
+
+} // namespace
+
 void install(jsi::Runtime& runtime, RuntimeExecutor runtimeExecutor) {
+  // All callbacks for the JavaScript thread go through the completion queue,
+  // which coalesces the callbacks that are ready at the same time.
+  auto completionQueue =
+      std::make_shared<common::CompletionQueue>(std::move(runtimeExecutor));
+  runtimeExecutor = completionQueue->executor();
+  {
+    std::lock_guard<std::mutex> lock(completionQueuesMutex);
+    completionQueues[&runtime] = completionQueue;
+  }
+
+  // The anchor is a hidden global, so it lives as long as the runtime. It is
+  // configurable, so installing the bindings again replaces it.
+  jsi::Object descriptor(runtime);
+  descriptor.setProperty(
+      runtime,
+      "value",
+      jsi::Object::createFromHostObject(
+          runtime,
+          std::make_shared<CompletionQueueAnchor>(runtime, completionQueue)));
+  descriptor.setProperty(runtime, "configurable", true);
+  runtime.global()
+      .getPropertyAsObject(runtime, "Object")
+      .getPropertyAsFunction(runtime, "defineProperty")
+      .call(
+          runtime,
+          runtime.global(),
+          "__torchliveCompletionQueue__",
+          std::move(descriptor));
+
   jsi::Object torchliveObject(runtime);
 
   auto torch = torch::buildNamespace(runtime, runtimeExecutor);
@@ -49,4 +116,24 @@ void install(jsi::Runtime& runtime, RuntimeExecutor runtimeExecutor) {
       runtime, "__torchlive__", std::move(torchliveObject));
 }
 
+RuntimeExecutor getRuntimeExecutor(jsi::Runtime& runtime) {
+  return getCompletionQueue(runtime)->executor();
+}
+
+std::shared_ptr<common::CompletionQueue> getCompletionQueue(
+    jsi::Runtime& runtime) {
+  auto completionQueue = findCompletionQueue(runtime);
+  if (completionQueue == nullptr) {
+    throw jsi::JSError(runtime, "PlayTorch is not installed in this runtime");
+  }
+  return completionQueue;
+}
+
+std::shared_ptr<common::CompletionQueue> findCompletionQueue(
+    jsi::Runtime& runtime) {
+  std::lock_guard<std::mutex> lock(completionQueuesMutex);
+  auto it = completionQueues.find(&runtime);
+  return it != completionQueues.end() ? it->second : nullptr;
+}
+
 } // namespace torchlive
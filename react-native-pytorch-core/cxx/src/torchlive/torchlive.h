@@ -8,6 +8,7 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 
 namespace facebook {
 namespace jsi {
@@ -19,6 +20,12 @@ class Runtime;
 
 namespace torchlive {
 
+namespace common {
+
+class CompletionQueue;
+
+} // namespace common
+
 using namespace facebook;
 
 // Match definition in ReactCommon/RuntimeExecutor.h to avoid React Native
@@ -30,4 +37,19 @@ using RuntimeExecutor =
 // thread, such as an asynchronous callback.
 void install(jsi::Runtime& runtime, RuntimeExecutor runtimeExecutor);
 
+// Returns the runtimeExecutor of the runtime, which batches the callbacks that
+// are passed to the runtimeExecutor passed to install (see
+// common::CompletionQueue). This is for objects that are not created by a
+// namespace and therefore can't capture the runtimeExecutor, like tensors.
+RuntimeExecutor getRuntimeExecutor(jsi::Runtime& runtime);
+
+// Returns the completion queue of the runtime.
+std::shared_ptr<common::CompletionQueue> getCompletionQueue(
+    jsi::Runtime& runtime);
+
+// Same as above, but returns nullptr instead of throwing if the bindings are
+// not installed in the runtime.
+std::shared_ptr<common::CompletionQueue> findCompletionQueue(
+    jsi::Runtime& runtime);
+
 } // namespace torchlive
@@ -11,6 +11,7 @@
 #include <torch/csrc/jit/mobile/import.h>
 #pragma clang diagnostic pop
 
+#include "../torch/jit/mobile/ModelLoader.h"
 #include "../torch/utils/helpers.h"
 #include "ATen/core/ivalue.h"
 #include "AbstractScriptModule.h"
@@ -29,9 +30,12 @@ AbstractScriptModule::AbstractScriptModule(
 torch_::jit::mobile::Module AbstractScriptModule::loadScriptModule(
     unsigned char* scriptedModule,
     unsigned int scriptModuleLength) {
-  std::stringstream is;
-  is.write((char*)scriptedModule, scriptModuleLength);
-  return torch_::jit::_load_for_mobile(is, torch_::kCPU);
+  // The scripted modules are static data, so the buffer doesn't own them.
+  std::shared_ptr<char> data(
+      reinterpret_cast<char*>(scriptedModule), [](char*) {});
+  torchlive::torch::jit::mobile::ExtraFilesMap extraFiles;
+  return torchlive::torch::jit::mobile::loadFromBuffer(
+      std::move(data), scriptModuleLength, torch_::kCPU, extraFiles);
 }
 
 c10::IValue AbstractScriptModule::forward(
@@ -74,11 +74,8 @@ static jsi::Function createJITScriptModuleFactory(jsi::Runtime& runtime) {
           runtimeExec, thisValueExec, argumentsExec, countExec);
       inputs.insert(inputs.end(), params.begin(), params.end());
       auto transformed = scriptModule->forward(inputs).toTensor();
-      auto transformedTensorHostObject =
-          std::make_shared<torchlive::torch::TensorHostObject>(
-              runtimeExec, transformed);
-      return jsi::Object::createFromHostObject(
-          runtimeExec, transformedTensorHostObject);
+      return utils::helpers::createFromHostObject<
+          torchlive::torch::TensorHostObject>(runtimeExec, transformed);
     };
     auto transform = jsi::Function::createFromHostFunction(
         runtimeFactory,
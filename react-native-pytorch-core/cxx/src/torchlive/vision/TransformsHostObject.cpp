@@ -141,11 +141,8 @@ jsi::Function TransformsHostObject::createCenterCrop(jsi::Runtime& runtime) {
       tensor = tensor.narrow(dims - 2, cropTop, cropHeight)
                    .narrow(dims - 1, cropLeft, cropWidth);
 
-      auto centerCroppedTensorHostObject =
-          std::make_shared<torchlive::torch::TensorHostObject>(
-              innerRuntime, tensor);
-      return jsi::Object::createFromHostObject(
-          innerRuntime, centerCroppedTensorHostObject);
+      return utils::helpers::createFromHostObject<
+          torchlive::torch::TensorHostObject>(innerRuntime, tensor);
     };
 
     return jsi::Function::createFromHostFunction(
@@ -228,11 +225,8 @@ jsi::Function TransformsHostObject::createNormalize(jsi::Runtime& runtime) {
 
       tensor.sub_(meanTensor).div_(stdTensor);
 
-      auto normalizedTensorHostObject =
-          std::make_shared<torchlive::torch::TensorHostObject>(
-              innerRuntime, tensor);
-      return jsi::Object::createFromHostObject(
-          innerRuntime, normalizedTensorHostObject);
+      return utils::helpers::createFromHostObject<
+          torchlive::torch::TensorHostObject>(innerRuntime, tensor);
     };
 
     return jsi::Function::createFromHostFunction(
@@ -295,11 +289,8 @@ jsi::Function TransformsHostObject::createResize(jsi::Runtime& runtime) {
         resizedTensor = resizedTensor.squeeze(0);
       }
 
-      auto resizedTensorHostObject =
-          std::make_shared<torchlive::torch::TensorHostObject>(
-              innerRuntime, resizedTensor);
-      return jsi::Object::createFromHostObject(
-          innerRuntime, resizedTensorHostObject);
+      return utils::helpers::createFromHostObject<
+          torchlive::torch::TensorHostObject>(innerRuntime, resizedTensor);
     };
 
     return jsi::Function::createFromHostFunction(
@@ -6,7 +6,12 @@
  */
 
 #include <gtest/gtest.h>
+#include <future>
+
+#include "torchlive/ThreadPool.h"
 #include "torchlive/common/AsyncTask.h"
+#include "torchlive/common/CancellationToken.h"
+#include "torchlive/common/CompletionQueue.h"
 #include "torchlive/torchlive.h"
 
 #include "TorchliveTestBase.h"
@@ -49,3 +54,139 @@ TEST_F(TorchliveAsyncTaskRuntimeTest, setupTaskFail) {
 
   // TODO(T124305556) Test AsyncFunc when RuntimeExecutor is available
 }
+
+TEST(TorchliveThreadPoolTest, priorityScope) {
+  using Priority = torchlive::ThreadPool::Priority;
+  using torchlive::ThreadPool;
+
+  EXPECT_FALSE(ThreadPool::scopedPriority().has_value());
+  {
+    ThreadPool::PriorityScope outer(Priority::kBackground);
+    EXPECT_EQ(ThreadPool::scopedPriority().value(), Priority::kBackground);
+    {
+      ThreadPool::PriorityScope inner(Priority::kInteractive);
+      EXPECT_EQ(ThreadPool::scopedPriority().value(), Priority::kInteractive);
+    }
+    EXPECT_EQ(ThreadPool::scopedPriority().value(), Priority::kBackground);
+  }
+  EXPECT_FALSE(ThreadPool::scopedPriority().has_value());
+}
+
+TEST(TorchliveThreadPoolTest, runInLanes) {
+  using Priority = torchlive::ThreadPool::Priority;
+  auto pool = torchlive::ThreadPool::pool();
+  auto before = pool->stats();
+
+  std::promise<void> interactiveDone;
+  std::promise<void> backgroundDone;
+  pool->run([&]() { interactiveDone.set_value(); }, Priority::kInteractive);
+  pool->run([&]() { backgroundDone.set_value(); }, Priority::kBackground);
+  interactiveDone.get_future().wait();
+  backgroundDone.get_future().wait();
+  pool->waitWorkComplete();
+
+  auto after = pool->stats();
+  EXPECT_EQ(after.interactive.completed, before.interactive.completed + 1);
+  EXPECT_EQ(after.background.completed, before.background.completed + 1);
+  EXPECT_EQ(after.interactive.queued, 0u);
+  EXPECT_EQ(after.background.queued, 0u);
+}
+
+TEST(TorchliveCancellationTokenTest, cancelWithParent) {
+  auto parent = std::make_shared<CancellationToken>("parent");
+  auto child = std::make_shared<CancellationToken>("child", parent);
+  EXPECT_EQ(child->cancellationReason(), nullptr);
+
+  parent->cancel();
+  ASSERT_NE(child->cancellationReason(), nullptr);
+  EXPECT_EQ(*child->cancellationReason(), "parent");
+
+  child->cancel();
+  EXPECT_EQ(*child->cancellationReason(), "child");
+}
+
+TEST(TorchliveCancellationTokenTest, scope) {
+  auto outerToken = std::make_shared<CancellationToken>("outer");
+  auto innerToken = std::make_shared<CancellationToken>("inner");
+  EXPECT_EQ(CancellationToken::current(), nullptr);
+  {
+    CancellationToken::Scope outer(outerToken);
+    EXPECT_EQ(CancellationToken::current(), outerToken);
+    {
+      CancellationToken::Scope inner(innerToken);
+      EXPECT_EQ(CancellationToken::current(), innerToken);
+    }
+    EXPECT_EQ(CancellationToken::current(), outerToken);
+  }
+  EXPECT_EQ(CancellationToken::current(), nullptr);
+}
+
+TEST_F(TorchliveAsyncTaskRuntimeTest, cancellationTokenFromAbortSignal) {
+  auto signal = eval(R"(
+    const listeners = [];
+    signal = {
+      aborted: false,
+      addEventListener: (type, listener) => listeners.push(listener),
+      abort: () => listeners.forEach(listener => listener()),
+    };
+  )");
+  auto token = CancellationToken::fromAbortSignal(*rt, signal);
+  EXPECT_EQ(token->cancellationReason(), nullptr);
+  eval("signal.abort()");
+  EXPECT_NE(token->cancellationReason(), nullptr);
+
+  auto abortedSignal = eval("({aborted: true, addEventListener: () => {}})");
+  auto abortedToken = CancellationToken::fromAbortSignal(*rt, abortedSignal);
+  EXPECT_NE(abortedToken->cancellationReason(), nullptr);
+
+  EXPECT_THROW(
+      CancellationToken::fromAbortSignal(*rt, eval("({})")), jsi::JSError);
+}
+
+TEST_F(TorchliveAsyncTaskRuntimeTest, completionQueueCoalescesCallbacks) {
+  std::vector<std::function<void(jsi::Runtime&)>> scheduled;
+  auto queue = std::make_shared<CompletionQueue>(
+      [&](std::function<void(jsi::Runtime&)>&& callback) {
+        scheduled.push_back(std::move(callback));
+      });
+  auto executor = queue->executor();
+
+  std::vector<int> order;
+  for (int i = 0; i < 3; i++) {
+    executor([&, i](jsi::Runtime&) { order.push_back(i); });
+  }
+  ASSERT_EQ(scheduled.size(), 1u);
+  scheduled[0](*rt);
+  EXPECT_EQ(order, std::vector<int>({0, 1, 2}));
+
+  executor([&](jsi::Runtime&) { order.push_back(3); });
+  ASSERT_EQ(scheduled.size(), 2u);
+  scheduled[1](*rt);
+  EXPECT_EQ(order, std::vector<int>({0, 1, 2, 3}));
+
+  auto stats = queue->stats();
+  EXPECT_EQ(stats.callbacks, 4u);
+  EXPECT_EQ(stats.drains, 2u);
+}
+
+TEST_F(TorchliveAsyncTaskRuntimeTest, completionQueueKeepsOrderOnException) {
+  std::vector<std::function<void(jsi::Runtime&)>> scheduled;
+  auto queue = std::make_shared<CompletionQueue>(
+      [&](std::function<void(jsi::Runtime&)>&& callback) {
+        scheduled.push_back(std::move(callback));
+      });
+  auto executor = queue->executor();
+
+  std::vector<int> order;
+  executor([&](jsi::Runtime&) { order.push_back(0); });
+  executor([&](jsi::Runtime&) { throw std::runtime_error("error"); });
+  executor([&](jsi::Runtime&) { order.push_back(2); });
+  ASSERT_EQ(scheduled.size(), 1u);
+  EXPECT_THROW(scheduled[0](*rt), std::runtime_error);
+  EXPECT_EQ(order, std::vector<int>({0}));
+
+  executor([&](jsi::Runtime&) { order.push_back(3); });
+  ASSERT_EQ(scheduled.size(), 2u);
+  scheduled[1](*rt);
+  EXPECT_EQ(order, std::vector<int>({0, 2, 3}));
+}
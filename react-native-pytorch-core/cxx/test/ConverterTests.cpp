@@ -6,8 +6,13 @@
  */
 
 #include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
 #include "ATen/core/dynamic_type.h"
+#include "torchlive/torch/IValueHostObject.h"
+#include "torchlive/torch/LazyValueHostObject.h"
 #include "torchlive/torch/TensorHostObject.h"
+#include "torchlive/torch/utils/StagedValue.h"
 #include "torchlive/torch/utils/converter.h"
 #include "torchlive/torch/utils/helpers.h"
 
@@ -187,6 +192,133 @@ TEST_F(TorchliveConverterRuntimeTest, TupleConversion) {
   EXPECT_EQ(childJsArr.getValueAtIndex(*rt, 1).getBool(), false);
 }
 
+TEST_F(TorchliveConverterRuntimeTest, LazyConversion) {
+  c10::Dict<std::string, c10::IValue> dict;
+  dict.insert("boxes", torch_::zeros({2, 4}));
+  dict.insert(
+      "labels",
+      std::tuple<std::string, std::vector<double>>("cat", {0.5, 0.25}));
+  c10::Dict<int64_t, std::string> names;
+  names.insert(-1, "none");
+  dict.insert("names", names);
+
+  // Scalars are converted as usual.
+  EXPECT_EQ(ivalueToLazyJSIValue(*rt, 41).asNumber(), 41);
+
+  auto jsval = ivalueToLazyJSIValue(*rt, dict);
+  auto obj = jsval.asObject(*rt);
+  EXPECT_TRUE(obj.isHostObject<torchlive::torch::LazyValueHostObject>(*rt));
+  EXPECT_EQ(obj.getPropertyNames(*rt).size(*rt), 4u); // including toJSON
+  auto boxes = obj.getProperty(*rt, "boxes");
+  auto unpacked = torchlive::utils::helpers::parseTensor(*rt, &boxes);
+  EXPECT_EQ(unpacked->tensor.sizes().vec(), std::vector<int64_t>({2, 4}));
+  // Converted elements are cached.
+  EXPECT_TRUE(jsi::Value::strictEquals(
+      *rt, boxes, obj.getProperty(*rt, "boxes")));
+  EXPECT_TRUE(obj.getProperty(*rt, "missing").isUndefined());
+
+  auto labels = obj.getProperty(*rt, "labels").asObject(*rt);
+  EXPECT_EQ(labels.getProperty(*rt, "length").asNumber(), 2);
+  EXPECT_EQ(labels.getProperty(*rt, "0").asString(*rt).utf8(*rt), "cat");
+  auto scores = labels.getProperty(*rt, "1").asObject(*rt);
+  EXPECT_EQ(scores.getProperty(*rt, "1").asNumber(), 0.25);
+  EXPECT_TRUE(scores.getProperty(*rt, "2").isUndefined());
+
+  auto namesObj = obj.getProperty(*rt, "names").asObject(*rt);
+  EXPECT_EQ(namesObj.getProperty(*rt, "-1").asString(*rt).utf8(*rt), "none");
+
+  // toJSON converts the whole value eagerly.
+  auto json = labels.getPropertyAsFunction(*rt, "toJSON")
+                  .callWithThis(*rt, labels)
+                  .asObject(*rt);
+  EXPECT_TRUE(json.isArray(*rt));
+  auto jsonScores = json.asArray(*rt).getValueAtIndex(*rt, 1).asObject(*rt);
+  EXPECT_TRUE(jsonScores.isArray(*rt));
+}
+
+TEST_F(TorchliveConverterRuntimeTest, StagedConversion) {
+  c10::Dict<std::string, c10::IValue> dict;
+  dict.insert("boxes", torch_::zeros({2, 4}));
+  dict.insert("scores", std::vector<double>({0.5, 0.25}));
+  dict.insert("labels", std::vector<int64_t>({3, 7}));
+  dict.insert(
+      "names",
+      std::tuple<std::string, bool, c10::nullopt_t>("cat", true, c10::nullopt));
+
+  // The staged value converts to the same value as ivalueToJSIValue.
+  auto staged = stageIValue(dict, false);
+  auto obj = stagedValueToJSIValue(*rt, std::move(staged)).asObject(*rt);
+  auto boxes = obj.getProperty(*rt, "boxes");
+  auto unpacked = torchlive::utils::helpers::parseTensor(*rt, &boxes);
+  EXPECT_EQ(unpacked->tensor.sizes().vec(), std::vector<int64_t>({2, 4}));
+  auto scores = obj.getProperty(*rt, "scores").asObject(*rt);
+  EXPECT_TRUE(scores.isArray(*rt));
+  EXPECT_EQ(scores.asArray(*rt).getValueAtIndex(*rt, 1).asNumber(), 0.25);
+  auto labels = obj.getProperty(*rt, "labels").asObject(*rt).asArray(*rt);
+  EXPECT_EQ(labels.getValueAtIndex(*rt, 1).asNumber(), 7);
+  auto names = obj.getProperty(*rt, "names").asObject(*rt).asArray(*rt);
+  EXPECT_EQ(names.length(*rt), 3u);
+  EXPECT_EQ(names.getValueAtIndex(*rt, 0).asString(*rt).utf8(*rt), "cat");
+  EXPECT_TRUE(names.getValueAtIndex(*rt, 1).getBool());
+  EXPECT_TRUE(names.getValueAtIndex(*rt, 2).isNull());
+
+  // Numeric lists become Float64Arrays with typed arrays.
+  auto typed = stagedValueToJSIValue(*rt, stageIValue(dict, true));
+  auto typedScores = typed.asObject(*rt).getProperty(*rt, "scores");
+  auto float64Array =
+      rt->global().getPropertyAsObject(*rt, "Float64Array").asFunction(*rt);
+  EXPECT_TRUE(typedScores.asObject(*rt).instanceOf(*rt, float64Array));
+  auto typedLabels = typed.asObject(*rt).getProperty(*rt, "labels");
+  EXPECT_EQ(typedLabels.asObject(*rt).getProperty(*rt, "1").asNumber(), 7);
+
+  EXPECT_THROW(
+      stageIValue(c10::IValue(c10::complex<double>(1, 2)), false),
+      std::runtime_error);
+}
+
+// Compares converting a wide dict output eagerly with converting it lazily and
+// reading one field, e.g.:
+//
+//   ./torchlive_tests --gtest_also_run_disabled_tests \
+//     --gtest_filter=TorchliveConverterRuntimeTest.DISABLED_LazyBenchmark
+TEST_F(TorchliveConverterRuntimeTest, DISABLED_LazyBenchmark) {
+  // A detector output with boxes, per-box features and masks.
+  c10::Dict<std::string, c10::IValue> output;
+  output.insert("boxes", torch_::rand({100, 4}));
+  output.insert("scores", std::vector<double>(100, 0.5));
+  c10::List<at::Tensor> features;
+  c10::List<c10::List<double>> masks;
+  for (int i = 0; i < 100; i++) {
+    features.push_back(torch_::rand({256}));
+    masks.push_back(c10::List<double>(std::vector<double>(28 * 28, 1.0)));
+  }
+  output.insert("features", features);
+  output.insert("masks", masks);
+  for (int i = 0; i < 100; i++) {
+    output.insert("extra" + std::to_string(i), std::vector<double>(100, 0.0));
+  }
+
+  const int iterations = 20;
+  using Clock = std::chrono::steady_clock;
+  auto start = Clock::now();
+  for (int i = 0; i < iterations; i++) {
+    ivalueToJSIValue(*rt, output).asObject(*rt).getProperty(*rt, "boxes");
+  }
+  auto eager = Clock::now() - start;
+  start = Clock::now();
+  for (int i = 0; i < iterations; i++) {
+    ivalueToLazyJSIValue(*rt, output).asObject(*rt).getProperty(*rt, "boxes");
+  }
+  auto lazy = Clock::now() - start;
+
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+  auto eagerTime = duration_cast<microseconds>(eager).count() / iterations;
+  auto lazyTime = duration_cast<microseconds>(lazy).count() / iterations;
+  std::cout << "eager: " << eagerTime << " us, lazy: " << lazyTime
+            << " us per output" << std::endl;
+}
+
 // jsi::Value to IValue conversion tests
 
 TEST_F(TorchliveConverterRuntimeTest, jsiValueNumberToIValue) {
@@ -335,6 +467,26 @@ TEST_F(TorchliveConverterRuntimeTest, jsValuecListToIValue) {
   EXPECT_EQ(iValue2.toList().vec()[1].toList().vec()[1].toList().vec()[0], 8);
 }
 
+TEST_F(TorchliveConverterRuntimeTest, jsValueTypedArrayToIValue) {
+  auto intListTypePtr = c10::DynamicType::create(
+      *c10::ListType::get("IntListPtr", c10::IntType::get()));
+  auto intArray = eval("new Int32Array([1, 2, 3])");
+  auto intIValue = jsiValuetoIValue(*rt, intArray, *intListTypePtr);
+  EXPECT_TRUE(intIValue.isIntList());
+  EXPECT_EQ(intIValue.toIntList().vec(), std::vector<int64_t>({1, 2, 3}));
+
+  auto floatListTypePtr = c10::DynamicType::create(
+      *c10::ListType::get("FloatListPtr", c10::FloatType::get()));
+  auto floatArray = eval("new Float32Array([0.5, 1.5])");
+  auto floatIValue = jsiValuetoIValue(*rt, floatArray, *floatListTypePtr);
+  EXPECT_TRUE(floatIValue.isDoubleList());
+  EXPECT_EQ(floatIValue.toDoubleList().vec(), std::vector<double>({0.5, 1.5}));
+
+  // Float data is not converted implicitly to List[int]
+  EXPECT_THROW(
+      jsiValuetoIValue(*rt, floatArray, *intListTypePtr), jsi::JSError);
+}
+
 TEST_F(TorchliveConverterRuntimeTest, jsiValueInputUnmatchIValue) {
   auto testTensor = torch_::tensor(
       std::vector<double>({1}), c10::TensorOptions().dtype(torch_::kInt32));
@@ -394,3 +546,34 @@ TEST_F(TorchliveConverterRuntimeTest, jsValueTupleToIValue) {
   EXPECT_EQ(
       iValue.toTuple()->elements().at(1).toTuple()->elements().at(1), "apple");
 }
+
+TEST_F(TorchliveConverterRuntimeTest, jsValueNativeIValueToIValue) {
+  auto tensorListTypePtr = c10::DynamicType::create(
+      *c10::ListType::get("TensorListPtr", c10::TensorType::get()));
+  auto tensor = torch_::rand({2, 3});
+  c10::List<at::Tensor> list({tensor, tensor});
+
+  // Native values pass through without a copy.
+  auto native = torchlive::utils::helpers::createFromHostObject<
+      torchlive::torch::IValueHostObject>(*rt, at::IValue(list));
+  auto iValue = jsiValuetoIValue(*rt, native, *tensorListTypePtr);
+  EXPECT_TRUE(iValue.isTensorList());
+  EXPECT_TRUE(iValue.toTensorList().get(1).is_same(tensor));
+
+  auto lazy = ivalueToLazyJSIValue(*rt, at::IValue(list));
+  iValue = jsiValuetoIValue(*rt, lazy, *tensorListTypePtr);
+  EXPECT_TRUE(iValue.isTensorList());
+  EXPECT_TRUE(iValue.toTensorList().get(0).is_same(tensor));
+
+  // A native tensor can be passed for a tensor argument.
+  auto nativeTensor = torchlive::utils::helpers::createFromHostObject<
+      torchlive::torch::IValueHostObject>(*rt, at::IValue(tensor));
+  iValue = jsiValuetoIValue(
+      *rt, nativeTensor, *c10::DynamicType::create(*c10::TensorType::get()));
+  EXPECT_TRUE(iValue.toTensor().is_same(tensor));
+
+  // Native values are checked against the expected type.
+  auto intTypePtr = c10::DynamicType::create(*c10::IntType::get());
+  EXPECT_THROW(jsiValuetoIValue(*rt, nativeTensor, *intTypePtr), jsi::JSError);
+  EXPECT_THROW(jsiValuetoIValue(*rt, native, *intTypePtr), jsi::JSError);
+}
@@ -352,6 +352,28 @@ TEST_F(TorchliveTensorRuntimeTest, TensorDataTest) {
       facebook::jsi::JSError);
 }
 
+TEST_F(TorchliveTensorRuntimeTest, TensorDataCopyTest) {
+  std::string tensorDataCopy =
+      R"(
+        const tensor = torch.tensor([1, 2, 3], {dtype: torch.float32});
+        const data = tensor.data({copy: true});
+        data[0] = 42;
+        data instanceof Float32Array && tensor[0].item() === 1 && data[1] === 2;
+      )";
+  EXPECT_TRUE(eval(tensorDataCopy).getBool());
+
+  std::string tensorDataNonContiguous =
+      R"(
+        const tensor = torch.tensor([[1, 2], [3, 4]], {dtype: torch.int32});
+        const data = tensor.permute([1, 0]).data();
+        [1, 3, 2, 4].every((v, i) => v === data[i]);
+      )";
+  EXPECT_TRUE(eval(tensorDataNonContiguous).getBool());
+
+  EXPECT_THROW(
+      eval("torch.tensor([1, 2]).data({copy: 'yes'})"), facebook::jsi::JSError);
+}
+
 TEST_F(TorchliveTensorRuntimeTest, TensorIndexing) {
   std::string tensorAccessWithIndex =
       R"(
@@ -374,6 +396,15 @@ TEST_F(TorchliveTensorRuntimeTest, TensorIndexing) {
   EXPECT_TRUE(eval("torch.tensor([[128], [255]])[-1]").isUndefined());
 
   EXPECT_TRUE(eval("torch.tensor([[128], [255]])[2]").isUndefined());
+
+  EXPECT_TRUE(eval("torch.tensor([[128], [255]])['01']").isObject());
+
+  EXPECT_TRUE(eval("torch.tensor([[128], [255]])['1e0']").isUndefined());
+
+  EXPECT_TRUE(eval("torch.tensor(42)[0]").isUndefined());
+
+  EXPECT_TRUE(
+      eval("torch.tensor([[128], [255]])[99999999999999999999]").isUndefined());
 }
 
 TEST_F(TorchliveTensorRuntimeTest, TensorIndexingPut) {
@@ -397,6 +428,15 @@ TEST_F(TorchliveTensorRuntimeTest, TensorIndexingPut) {
       )";
   EXPECT_TRUE(eval(tensorPutWithIndexAndNumberValue).getBool());
 
+  std::string tensorPutWithNegativeIndex =
+      R"(
+        const tensor = torch.zeros([3]);
+        tensor[-1] = 3;
+        tensor[-3] = torch.tensor([1]);
+        tensor[0].item() === 1 && tensor[1].item() === 0 && tensor[2].item() === 3;
+      )";
+  EXPECT_TRUE(eval(tensorPutWithNegativeIndex).getBool());
+
   std::string nestedTensorPutWithIndex =
       R"(
         const tensor = torch.tensor([[128], [0]]);
@@ -416,6 +456,18 @@ TEST_F(TorchliveTensorRuntimeTest, TensorIndexingPut) {
 
   EXPECT_THROW(
       eval("torch.tensor([[128], [255]])[2] = 'bar'"), facebook::jsi::JSError);
+
+  EXPECT_THROW(
+      eval("torch.tensor([[128], [255]])['foo'] = 1"), facebook::jsi::JSError);
+
+  EXPECT_THROW(
+      eval("torch.tensor([[128], [255]])[2] = 1"), facebook::jsi::JSError);
+
+  EXPECT_THROW(
+      eval("torch.tensor([[128], [255]])[-3] = 1"), facebook::jsi::JSError);
+
+  EXPECT_THROW(
+      eval("torch.tensor([[128], [255]])['-'] = 1"), facebook::jsi::JSError);
 }
 
 TEST_F(TorchliveTensorRuntimeTest, TensorDivTest) {
@@ -1106,4 +1158,63 @@ TEST_F(TorchliveTensorRuntimeTest, TensorReshapeTest) {
   EXPECT_THROW(eval(tensorReshapeFor2x3), facebook::jsi::JSError);
 }
 
+TEST_F(TorchliveTensorRuntimeTest, TensorSharedMethodsTest) {
+  std::string tensorSharedMethods =
+      R"(
+        const tensor1 = torch.tensor([0, 1]);
+        const tensor2 = torch.ones([2, 3]);
+        tensor1.add === tensor2.add && tensor1.size === tensor2.size &&
+          tensor1.toString === tensor2.toString;
+      )";
+  EXPECT_TRUE(eval(tensorSharedMethods).getBool());
+
+  std::string tensorSharedMethodsDispatchOnThis =
+      R"(
+        const tensor1 = torch.tensor([0, 1]);
+        const tensor2 = torch.ones([2, 3]);
+        const size = tensor1.size;
+        const shape = size.call(tensor2);
+        shape[0] === 2 && shape[1] === 3 && tensor2.shape[1] === 3;
+      )";
+  EXPECT_TRUE(eval(tensorSharedMethodsDispatchOnThis).getBool());
+
+  std::string tensorComputedPropertyNames =
+      R"(
+        const tensor = torch.ones([2, 3], {dtype: torch.int32});
+        const dtype = 'dt' + 'ype';
+        const shape = 'sh' + 'ape';
+        const abs = 'ab' + 's';
+        tensor[dtype] === 'int32' && tensor[shape][1] === 3 &&
+          tensor[abs] === tensor.abs;
+      )";
+  EXPECT_TRUE(eval(tensorComputedPropertyNames).getBool());
+}
+
+TEST_F(TorchliveTensorRuntimeTest, TensorAsyncOpsTest) {
+  // Only the argument parsing is tested here, because the runtimeExecutor of
+  // the test runtime doesn't support asynchronous execution. Invalid arguments
+  // reject the Promise before the op is scheduled. The Promise implementation
+  // calls catch handlers with setImmediate, which is called right away here.
+  std::string tensorAsyncOpsRejectInvalidArguments =
+      R"(
+        globalThis.setImmediate = (callback, ...args) => callback(...args);
+        const tensor = torch.ones([2, 3]);
+        const promises = [
+          tensor.matmulAsync(),
+          tensor.softmaxAsync(),
+          tensor.sumAsync(0, {keepdim: 1}),
+          tensor.toAsync(),
+          tensor.topkAsync(1, {largest: 1}),
+        ];
+        const errors = [];
+        promises.forEach(p => p.catch(e => errors.push(e)));
+        promises.every(p => p instanceof Promise) &&
+          errors.length === promises.length &&
+          errors.every(e => e instanceof Error && e.message.length > 0) &&
+          errors[2].message.includes('keepdim') &&
+          errors[4].message.includes('largest');
+      )";
+  EXPECT_TRUE(eval(tensorAsyncOpsRejectInvalidArguments).getBool());
+}
+
 } // namespace
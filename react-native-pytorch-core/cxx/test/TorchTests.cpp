@@ -5,11 +5,40 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <ATen/Parallel.h>
 #include <fmt/format.h>
 #include <gtest/gtest.h>
+#include <sys/resource.h>
+#include <torch/csrc/jit/mobile/import.h>
+#include <torch/script.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "TorchliveTestBase.h"
+#include "torchlive/common/ExternalMemory.h"
+#include "torchlive/filesystem/FilesystemNamespace.h"
+#include "torchlive/torch/jit/mobile/CachingAllocator.h"
+#include "torchlive/torch/jit/mobile/IntraOpThreads.h"
+#include "torchlive/torch/jit/mobile/MethodBatcher.h"
+#include "torchlive/torch/jit/mobile/ModelLoader.h"
+#include "torchlive/torch/jit/mobile/ModelRegistry.h"
+#include "torchlive/torch/jit/mobile/ModelWarmup.h"
+#include "torchlive/torch/jit/mobile/ModuleHostObject.h"
+#include "torchlive/torch/jit/mobile/ModulePool.h"
+#include "torchlive/torch/jit/mobile/OpProfiler.h"
+#include "torchlive/torchvision/scripted/grayscale_scriptmodule.h"
 
 namespace {
 
@@ -18,6 +47,50 @@ class TorchliveRuntimeTest : public torchlive::test::TorchliveBindingsTestBase {
   TorchliveRuntimeTest() : torchlive::test::TorchliveBindingsTestBase() {
     importTorchliveModule("media");
   }
+
+ protected:
+  // Exposes the bytes of the grayscale torchvision module as the global
+  // grayscaleModel ArrayBuffer.
+  void setGrayscaleModel() {
+    auto size = grayscale_scriptmodule_ptl_len;
+    auto buffer = rt->global()
+                      .getPropertyAsFunction(*rt, "ArrayBuffer")
+                      .callAsConstructor(*rt, static_cast<int>(size))
+                      .asObject(*rt)
+                      .getArrayBuffer(*rt);
+    std::memcpy(buffer.data(*rt), grayscale_scriptmodule_ptl, size);
+    rt->global().setProperty(*rt, "grayscaleModel", std::move(buffer));
+  }
+
+  using Callback = std::function<void(facebook::jsi::Runtime& runtime)>;
+
+  // Reinstalls the bindings with a runtime executor that queues callbacks until
+  // runQueuedCallbacks is called, like tasks on the JavaScript thread. The
+  // callbacks can be queued from any thread.
+  void installQueuedExecutor() {
+    torchlive::install(*rt, [this](Callback&& callback) {
+      std::lock_guard<std::mutex> lock(queuedCallbacksMutex_);
+      queuedCallbacks_.push_back(std::move(callback));
+    });
+    importTorchliveModule("torch");
+    importTorchliveModule("media");
+  }
+
+  void runQueuedCallbacks() {
+    std::vector<Callback> callbacks;
+    {
+      std::lock_guard<std::mutex> lock(queuedCallbacksMutex_);
+      callbacks = std::move(queuedCallbacks_);
+      queuedCallbacks_.clear();
+    }
+    for (auto& callback : callbacks) {
+      callback(*rt);
+    }
+  }
+
+ private:
+  std::mutex queuedCallbacksMutex_;
+  std::vector<Callback> queuedCallbacks_;
 };
 
 TEST_F(TorchliveRuntimeTest, TorchObjectTest) {
@@ -145,6 +218,35 @@ TEST_F(TorchliveRuntimeTest, TensorDataTest) {
       eval(
           "torch.rand([5], {dtype: torch.double}).data() instanceof Float64Array")
           .getBool());
+
+  // A copy doesn't share memory with the tensor.
+  std::string copiedData =
+      R"(
+        const tensor = torch.tensor([1, 2, 3]);
+        const data = tensor.data({copy: true});
+        data[0] = 5;
+        tensor[0].item() === 1;
+      )";
+  EXPECT_TRUE(eval(copiedData).getBool());
+  EXPECT_THROW(
+      eval("torch.tensor([1, 2, 3]).data({copy: 1})"), facebook::jsi::JSError);
+
+#ifdef TORCHLIVE_JSI_MUTABLE_BUFFER
+  // The data shares memory with the tensor, and keeps the memory alive after
+  // the tensor is disposed and its host object is collected.
+  std::string sharedData =
+      R"(
+        globalThis.tensor = torch.tensor([1, 2, 3]);
+        globalThis.data = tensor.data();
+        data[0] = 5;
+        tensor[0].item() === 5;
+      )";
+  EXPECT_TRUE(eval(sharedData).getBool());
+  eval("tensor.dispose(); delete globalThis.tensor;");
+  rt->instrumentation().collectGarbage("test");
+  EXPECT_TRUE(
+      eval("data[0] === 5 && data[1] === 2 && data[2] === 3").getBool());
+#endif
 }
 
 TEST_F(TorchliveRuntimeTest, TensorToStringTest) {
@@ -331,6 +433,64 @@ TEST_F(TorchliveRuntimeTest, TorchTensorTest) {
       facebook::jsi::JSError);
 }
 
+TEST_F(TorchliveRuntimeTest, TorchTensorFromTypedArrayTest) {
+  std::string torchCreateTensorFromTypedArray =
+      R"(
+          const tensor = torch.tensor(new Float32Array([1, 2, 3, 4, 5, 6]));
+          tensor.dtype == torch.float32 && tensor.shape.length == 1 &&
+            tensor.shape[0] == 6 && tensor[5].item() == 6;
+        )";
+  EXPECT_TRUE(eval(torchCreateTensorFromTypedArray).getBool());
+  std::string torchCreateTensorFromTypedArrayShape =
+      R"(
+          const tensor = torch.tensor(new Int32Array([1, 2, 3, 4, 5, 6]), {shape: [2, 3]});
+          tensor.dtype == torch.int32 && tensor.shape[0] == 2 &&
+            tensor.shape[1] == 3 && tensor[1][0].item() == 4;
+        )";
+  EXPECT_TRUE(eval(torchCreateTensorFromTypedArrayShape).getBool());
+  std::string torchCreateTensorFromTypedArrayDtype =
+      R"(
+          const array = new Uint8Array([0, 1, 2, 3, 4, 5, 6, 7]);
+          const view = new Uint8Array(array.buffer, 4, 4);
+          const tensor = torch.tensor(view, {dtype: torch.float32});
+          tensor.dtype == torch.float32 && tensor.shape[0] == 4 &&
+            tensor[0].item() == 4;
+        )";
+  EXPECT_TRUE(eval(torchCreateTensorFromTypedArrayDtype).getBool());
+  std::string torchCreateTensorFromArrayBuffer =
+      R"(
+          const tensor = torch.tensor(new Uint8Array([7, 8]).buffer);
+          tensor.dtype == torch.uint8 && tensor[1].item() == 8;
+        )";
+  EXPECT_TRUE(eval(torchCreateTensorFromArrayBuffer).getBool());
+  // the shape must match the number of elements
+  EXPECT_THROW(
+      eval("torch.tensor(new Float32Array(6), {shape: [4, 2]})"),
+      facebook::jsi::JSError);
+  // Uint32 has no matching dtype
+  EXPECT_THROW(
+      eval("torch.tensor(new Uint32Array(6))"), facebook::jsi::JSError);
+  // the range of an object that isn't a TypedArray must be within its buffer
+  std::string spoofedTypedArray =
+      R"(
+          torch.tensor({
+            constructor: {name: 'Float32Array'},
+            buffer: new ArrayBuffer(16),
+            byteOffset: 1e6,
+            length: 10,
+          });
+        )";
+  EXPECT_THROW(eval(spoofedTypedArray), facebook::jsi::JSError);
+  EXPECT_THROW(
+      eval("torch.tensor({constructor: {name: 'Float32Array'}, "
+           "buffer: new ArrayBuffer(16), byteOffset: 0, length: 5})"),
+      facebook::jsi::JSError);
+  EXPECT_THROW(
+      eval("torch.tensor({constructor: {name: 'Float32Array'}, "
+           "buffer: new ArrayBuffer(16), byteOffset: 0.5, length: 1})"),
+      facebook::jsi::JSError);
+}
+
 TEST_F(TorchliveRuntimeTest, TorchRandTest) {
   // there must be at least one argument
   EXPECT_THROW(eval("torch.rand()"), facebook::jsi::JSError);
@@ -571,6 +731,33 @@ TEST_F(TorchliveRuntimeTest, TorchFromBlobTest) {
           data1.every((value, i) => value === data2[i]);
       )";
   EXPECT_TRUE(eval(blob + blobToTensor).getBool());
+
+  // The sizes must not exceed the blob size
+  std::string exceedingSize = "const tensor2 = torch.fromBlob(blob, [4]);";
+  EXPECT_THROW(eval(blob + exceedingSize), facebook::jsi::JSError);
+  // The byte count of these sizes overflows to 0.
+  std::string overflowingSize =
+      "const tensor2 = torch.fromBlob(blob, [2 ** 62, 4]);";
+  EXPECT_THROW(eval(blob + overflowingSize), facebook::jsi::JSError);
+  std::string hugeSize = "const tensor2 = torch.fromBlob(blob, [2 ** 70]);";
+  EXPECT_THROW(eval(blob + hugeSize), facebook::jsi::JSError);
+  std::string exceedingDtypeSize =
+      "const tensor2 = torch.fromBlob(blob, [3], {dtype: torch.int32});";
+  EXPECT_THROW(eval(blob + exceedingDtypeSize), facebook::jsi::JSError);
+  // The sizes must be finite integers
+  for (auto size : {"NaN", "1.5", "-Infinity", "-(2 ** 70)"}) {
+    std::string invalidSize =
+        fmt::format("const tensor2 = torch.fromBlob(blob, [{}]);", size);
+    EXPECT_THROW(eval(blob + invalidSize), facebook::jsi::JSError);
+  }
+
+  // Test converting a sliced blob to tensor
+  std::string slicedBlobToTensor =
+      R"(
+          const tensor2 = torch.fromBlob(blob.slice(1), [2]);
+          tensor2[0].item() === 2 && tensor2[1].item() === 4;
+      )";
+  EXPECT_TRUE(eval(blob + slicedBlobToTensor).getBool());
 }
 
 TEST_F(TorchliveRuntimeTest, TorchFullTest) {
@@ -752,4 +939,898 @@ TEST_F(TorchliveRuntimeTest, TorchRandnTest) {
   EXPECT_THROW(eval("torch.randn(2,3)"), facebook::jsi::JSError);
 }
 
+TEST_F(TorchliveRuntimeTest, TensorDisposeTest) {
+  std::string dispose =
+      R"(
+        const tensor = torch.rand([2]);
+        const before = torch.getTensorStats();
+        tensor.dispose();
+        tensor.dispose();
+        const after = torch.getTensorStats();
+        after.freed - before.freed === 1 && after.live === before.live - 1;
+      )";
+  EXPECT_TRUE(eval(dispose).getBool());
+  EXPECT_THROW(
+      eval("const t = torch.rand([2]); t.dispose(); t.shape"),
+      facebook::jsi::JSError);
+  EXPECT_THROW(
+      eval("const t = torch.rand([2]); t.dispose(); torch.rand([2]).add(t)"),
+      facebook::jsi::JSError);
+}
+
+TEST_F(TorchliveRuntimeTest, TorchScopeTest) {
+  std::string scope =
+      R"(
+        const before = torch.getTensorStats();
+        let temporary;
+        let kept;
+        const result = torch.scope(() => {
+          temporary = torch.rand([2]);
+          kept = torch.keep(temporary.mul(2));
+          const nested = torch.scope(() => [temporary.add(1)]);
+          return {sum: nested[0].sum()};
+        });
+        const after = torch.getTensorStats();
+        // temporary, kept, nested[0] and sum are allocated, and only
+        // temporary and nested[0] are freed.
+        result.sum.item() > 0 && kept.shape[0] === 2 &&
+          after.allocated - before.allocated === 4 &&
+          after.freed - before.freed === 2;
+      )";
+  EXPECT_TRUE(eval(scope).getBool());
+  std::string throwing =
+      R"(
+        const before = torch.getTensorStats();
+        try {
+          torch.scope(() => {
+            torch.rand([2]);
+            throw new Error('failed');
+          });
+        } catch (e) {}
+        torch.getTensorStats().live === before.live;
+      )";
+  EXPECT_TRUE(eval(throwing).getBool());
+  EXPECT_THROW(eval("torch.scope(1)"), facebook::jsi::JSError);
+}
+
+TEST_F(TorchliveRuntimeTest, ExternalMemoryAliasTest) {
+  using torchlive::common::getReportedExternalMemory;
+  auto before = getReportedExternalMemory();
+  eval("globalThis.t = torch.zeros([256, 256], {dtype: torch.uint8});");
+  EXPECT_EQ(getReportedExternalMemory() - before, 256 * 256);
+
+  // Views, slices, and tensors created from a blob share the reported memory.
+  std::string aliases =
+      R"(
+        globalThis.views = [t[0], t[1], t[0][1]];
+        globalThis.blob = media.toBlob(t);
+        globalThis.slice = blob.slice(1024);
+        globalThis.fromBlob = torch.fromBlob(slice, [256]);
+      )";
+  eval(aliases);
+  EXPECT_EQ(getReportedExternalMemory() - before, 2 * 256 * 256);
+
+  // The memory is released with the last host object that holds it.
+  eval("delete globalThis.t; delete globalThis.blob;");
+  rt->instrumentation().collectGarbage("test");
+  EXPECT_EQ(getReportedExternalMemory() - before, 2 * 256 * 256);
+  eval("t = views[0]; t.dispose(); views = []; slice = fromBlob = undefined;");
+  rt->instrumentation().collectGarbage("test");
+  EXPECT_EQ(getReportedExternalMemory(), before);
+}
+
+#ifndef TORCHLIVE_JSI_EXTERNAL_MEMORY
+TEST_F(TorchliveRuntimeTest, ExternalMemoryBudgetTest) {
+  installQueuedExecutor();
+  auto collections = [this]() {
+    return rt->instrumentation().getHeapInfo(false)["hermes_numCollections"];
+  };
+  auto budget = torchlive::common::getExternalMemoryBudget();
+  torchlive::common::setExternalMemoryBudget(1024 * 1024);
+
+  // Each task creates 4 MiB of tensors that are unreachable after the task.
+  // The garbage collections are requested between the tasks.
+  eval("globalThis.before = torch.getTensorStats();");
+  for (int i = 0; i < 4; i++) {
+    auto collectionsBefore = collections();
+    eval("for (let i = 0; i < 16; i++) { torch.zeros([256, 256]); }");
+    EXPECT_EQ(collections(), collectionsBefore);
+    runQueuedCallbacks();
+    EXPECT_GT(collections(), collectionsBefore);
+  }
+  EXPECT_TRUE(eval("torch.getTensorStats().freed > before.freed").getBool());
+
+  // While the tensors stay reachable, the collections free nothing, and the
+  // budget grows, so not every task requests one.
+  eval("globalThis.tensors = [];");
+  auto collectionsBefore = collections();
+  int tasks = 8;
+  std::string grow =
+      "for (let i = 0; i < 8; i++) { tensors.push(torch.zeros([256, 256])); }";
+  for (int i = 0; i < tasks; i++) {
+    eval(grow);
+    runQueuedCallbacks();
+  }
+  auto reachableCollections = collections() - collectionsBefore;
+  torchlive::common::setExternalMemoryBudget(budget);
+
+  EXPECT_GT(reachableCollections, 0);
+  EXPECT_LT(reachableCollections, tasks);
+}
+
+TEST_F(TorchliveRuntimeTest, ExternalMemoryWithoutBindingsTest) {
+  installQueuedExecutor();
+  auto collections = [this]() {
+    return rt->instrumentation().getHeapInfo(false)["hermes_numCollections"];
+  };
+  auto budget = torchlive::common::getExternalMemoryBudget();
+  torchlive::common::setExternalMemoryBudget(1024);
+
+  // Memory reported in a runtime without the bindings can't schedule the
+  // check, which doesn't fail the report.
+  auto other = facebook::hermes::makeHermesRuntime();
+  facebook::jsi::Object object(*other);
+  torchlive::common::ExternalMemory handle{nullptr, 0};
+  EXPECT_NO_THROW(
+      handle = torchlive::common::reportExternalMemory(
+          *other, object, {nullptr, 4096}));
+  torchlive::common::releaseExternalMemory(handle);
+
+  // The next report over budget schedules the check.
+  auto collectionsBefore = collections();
+  eval("torch.zeros([256, 256]);");
+  runQueuedCallbacks();
+  torchlive::common::setExternalMemoryBudget(budget);
+  EXPECT_GT(collections(), collectionsBefore);
+}
+#endif
+
+// Prints the peak RSS of tasks that create tensors without keeping them.
+// Compare the peak RSS of separate runs with different settings:
+//   TORCHLIVE_BENCHMARK_BUDGET: The external memory budget in bytes, or 0 to
+//   never request garbage collections.
+//   TORCHLIVE_BENCHMARK_SCOPE=1: Dispose the tensors of each task with
+//   torch.scope.
+TEST_F(TorchliveRuntimeTest, DISABLED_TensorChurnBenchmark) {
+  installQueuedExecutor();
+  auto budget = torchlive::common::getExternalMemoryBudget();
+  const char* budgetEnv = std::getenv("TORCHLIVE_BENCHMARK_BUDGET");
+  if (budgetEnv != nullptr) {
+    auto bytes = std::stoull(budgetEnv);
+    torchlive::common::setExternalMemoryBudget(
+        bytes > 0 ? bytes : std::numeric_limits<std::size_t>::max());
+  }
+  const char* scopeEnv = std::getenv("TORCHLIVE_BENCHMARK_SCOPE");
+  bool scope = scopeEnv != nullptr && std::string(scopeEnv) == "1";
+
+  eval(
+      "globalThis.step = () => "
+      "torch.rand([1, 3, 224, 224]).mul(2).add(1).sum();");
+  std::string task = scope ? "torch.scope(step);" : "step();";
+  for (int i = 0; i < 1000; i++) {
+    eval(task);
+    runQueuedCallbacks();
+  }
+  auto live = eval("torch.getTensorStats().live;").getNumber();
+  auto usedBudget = torchlive::common::getExternalMemoryBudget();
+  torchlive::common::setExternalMemoryBudget(budget);
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  std::cout << "budget: " << usedBudget
+            << ", scope: " << scope << ", live tensors: " << live
+            << ", peak RSS: " << usage.ru_maxrss << std::endl;
+}
+
+TEST_F(TorchliveRuntimeTest, TorchJitModelCacheTest) {
+  std::string modelCacheStats =
+      R"(
+        torch.jit.setModelCacheBudget(1024);
+        const stats = torch.jit.getModelCacheStats();
+        torch.jit.setModelCacheBudget(256 * 1024 * 1024);
+        stats.budgetBytes === 1024 && stats.residentBytes === 0 &&
+          stats.models.length === 0;
+      )";
+  EXPECT_TRUE(eval(modelCacheStats).getBool());
+
+  EXPECT_THROW(
+      eval("torch.jit.setModelCacheBudget(-1)"), facebook::jsi::JSError);
+  EXPECT_THROW(
+      eval("torch.jit.setModelCacheBudget()"), facebook::jsi::JSError);
+}
+
+TEST_F(TorchliveRuntimeTest, TorchJitLoadOptionsTest) {
+  EXPECT_THROW(
+      eval("torch.jit._loadForMobileSync('model.ptl', undefined, undefined, "
+           "{mmap: 1})"),
+      facebook::jsi::JSError);
+}
+
+TEST_F(TorchliveRuntimeTest, TorchJitLoadFromBytesTest) {
+  EXPECT_THROW(
+      eval("torch.jit._loadForMobileSync({})"), facebook::jsi::JSError);
+  // The bytes are passed to the model loader, which rejects invalid models.
+  EXPECT_THROW(
+      eval("torch.jit._loadForMobileSync(new ArrayBuffer(16))"),
+      facebook::jsi::JSError);
+  EXPECT_THROW(
+      eval("torch.jit._loadForMobileSync(new Uint8Array(16).subarray(4))"),
+      facebook::jsi::JSError);
+  // The range of an object that isn't a typed array is checked before the
+  // bytes are read.
+  std::string rejectRanges =
+      R"(
+        const buffer = new ArrayBuffer(16);
+        const ranges = [[8, 16], [1e6, 1], [-1, 4], [0.5, 4], [0, NaN]];
+        ranges.every(([byteOffset, byteLength]) => {
+          try {
+            torch.jit._loadForMobileSync({buffer, byteOffset, byteLength});
+            return false;
+          } catch (e) {
+            return e.message.includes('exceed the size') ||
+              e.message.includes('non-negative integer');
+          }
+        });
+      )";
+  EXPECT_TRUE(eval(rejectRanges).getBool());
+}
+
+TEST_F(TorchliveRuntimeTest, ModuleMethodTest) {
+  setGrayscaleModel();
+
+  std::string moduleMethod =
+      R"(
+        const model = torch.jit._loadForMobileSync(grayscaleModel);
+        const forwardSync = model.forwardSync;
+        // Calls use the method resolved on first access. The omitted argument
+        // num_channels takes its default value.
+        const first = forwardSync(torch.rand([3, 4, 4]));
+        const second = model.forwardSync(torch.rand([3, 4, 4]), 3);
+        model.forwardSync === forwardSync && model.forward === model.forward &&
+          model.notAMethod === undefined && first.shape[0] === 1 &&
+          second.shape[0] === 3;
+      )";
+  EXPECT_TRUE(eval(moduleMethod).getBool());
+}
+
+TEST_F(TorchliveRuntimeTest, ModuleWithoutForwardTest) {
+  // A module with no methods, e.g., a model that only exports other methods.
+  auto type = c10::ClassType::create(
+      c10::QualifiedName("__torch__.NoForward"),
+      std::weak_ptr<torch_::jit::CompilationUnit>(),
+      /* is_module */ true);
+  auto object =
+      c10::ivalue::Object::create(c10::StrongTypePtr(nullptr, type), 0);
+  torch_::jit::mobile::Module module(
+      object, std::make_shared<torch_::jit::mobile::CompilationUnit>());
+  auto hostObject =
+      std::make_shared<torchlive::torch::jit::mobile::ModuleHostObject>(
+          *rt, torchlive::getRuntimeExecutor(*rt), module);
+  rt->global().setProperty(
+      *rt,
+      "model",
+      facebook::jsi::Object::createFromHostObject(*rt, hostObject));
+
+  std::string withoutForward =
+      R"(
+        model.forward === undefined && model.forwardSync === undefined &&
+          !Object.keys(model).includes('forward') &&
+          typeof model.setReplicas === 'function';
+      )";
+  EXPECT_TRUE(eval(withoutForward).getBool());
+  EXPECT_THROW(
+      eval("model.setLatestWins('forward', true)"), facebook::jsi::JSError);
+}
+
+TEST_F(TorchliveRuntimeTest, ModuleReplicasTest) {
+  setGrayscaleModel();
+  std::string moduleReplicas =
+      R"(
+        const model = torch.jit._loadForMobileSync(grayscaleModel);
+        const emptyStats = model.getReplicaStats();
+        model.setReplicas(2);
+        for (let i = 0; i < 3; i++) {
+          model.forwardSync(torch.rand([3, 4, 4]));
+        }
+        const stats = model.getReplicaStats();
+        model.setReplicas(0);
+        emptyStats.replicas.length === 0 && stats.replicas.length === 2 &&
+          stats.replicas[0].calls + stats.replicas[1].calls === 3 &&
+          stats.queued === 0 && stats.replicas[0].utilization <= 1 &&
+          model.getReplicaStats().replicas.length === 0;
+      )";
+  EXPECT_TRUE(eval(moduleReplicas).getBool());
+
+  EXPECT_THROW(
+      eval("torch.jit._loadForMobileSync(grayscaleModel).setReplicas(-1)"),
+      facebook::jsi::JSError);
+  EXPECT_THROW(
+      eval("torch.jit._loadForMobileSync(grayscaleModel).setReplicas(1.5)"),
+      facebook::jsi::JSError);
+}
+
+TEST_F(TorchliveRuntimeTest, ModuleLatestWinsTest) {
+  installQueuedExecutor();
+  setGrayscaleModel();
+  std::string callForward =
+      R"(
+        // The Promise implementation calls the handlers with setImmediate.
+        globalThis.setImmediate = (callback, ...args) => callback(...args);
+        const model = torch.jit._loadForMobileSync(grayscaleModel);
+        model.setLatestWins('forward', true);
+        globalThis.results = [];
+        for (let i = 0; i < 3; i++) {
+          model.forward(torch.rand([3, 4, 4])).then(
+            () => { results[i] = 'resolved'; },
+            e => { results[i] = e.name; });
+        }
+      )";
+  eval(callForward);
+
+  // The first call runs, the second call is replaced by the third call while
+  // it waits, and the third call starts once the first call settled.
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (!eval("results.filter(r => r !== undefined).length === 3").getBool() &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    runQueuedCallbacks();
+  }
+  EXPECT_TRUE(
+      eval("results[0] === 'resolved' && results[1] === 'AbortError' && "
+           "results[2] === 'resolved';")
+          .getBool());
+}
+
+TEST_F(TorchliveRuntimeTest, ModuleBatchingTest) {
+  setGrayscaleModel();
+  std::string moduleBatching =
+      R"(
+        const model = torch.jit._loadForMobileSync(grayscaleModel);
+        const forward = model.forward;
+        model.setBatching('forward', {maxBatchSize: 4, maxDelay: 2});
+        const batchedForward = model.forward;
+        const stats = model.getBatchStats('forward');
+        model.setBatching('forward', null);
+        batchedForward !== forward && model.forward === forward &&
+          stats.batchSizes.length === 4 &&
+          stats.batchSizes.every(count => count === 0) &&
+          model.getBatchStats('forward') === undefined;
+      )";
+  EXPECT_TRUE(eval(moduleBatching).getBool());
+
+  // Large batch sizes are clamped.
+  std::string clampedBatching =
+      R"(
+        const clamped = torch.jit._loadForMobileSync(grayscaleModel);
+        clamped.setBatching('forward', {maxBatchSize: 1e300});
+        clamped.getBatchStats('forward').batchSizes.length === 256;
+      )";
+  EXPECT_TRUE(eval(clampedBatching).getBool());
+
+  EXPECT_THROW(
+      eval("torch.jit._loadForMobileSync(grayscaleModel)"
+           ".setBatching('forward', {maxBatchSize: 0})"),
+      facebook::jsi::JSError);
+  EXPECT_THROW(
+      eval("torch.jit._loadForMobileSync(grayscaleModel)"
+           ".setBatching('detect', {})"),
+      facebook::jsi::JSError);
+}
+
+TEST_F(TorchliveRuntimeTest, ModuleCachingAllocatorTest) {
+  setGrayscaleModel();
+  std::string allocator =
+      R"(
+        const model = torch.jit._loadForMobileSync(grayscaleModel);
+        const input = torch.rand([1, 3, 4, 4]);
+        const disabled = model.getAllocatorStats();
+        model.setCachingAllocator(true);
+        model.forwardSync(input);
+        model.forwardSync(input);
+        const stats = model.getAllocatorStats();
+        model.trimMemory();
+        const trimmed = model.getAllocatorStats();
+        model.setCachingAllocator(false);
+        disabled === undefined && stats.hits <= stats.allocations &&
+          stats.hitRate >= 0 && stats.hitRate <= 1 &&
+          trimmed.cachedBytes === 0 &&
+          trimmed.allocations === stats.allocations &&
+          model.getAllocatorStats() === undefined &&
+          model.forwardSync(input).shape[1] === 1;
+      )";
+  EXPECT_TRUE(eval(allocator).getBool());
+  EXPECT_THROW(
+      eval("torch.jit._loadForMobileSync(grayscaleModel)"
+           ".setCachingAllocator(1)"),
+      facebook::jsi::JSError);
+}
+
+TEST_F(TorchliveRuntimeTest, ModuleNumThreadsTest) {
+  setGrayscaleModel();
+  std::string threads =
+      R"(
+        const defaultThreads = torch.getNumThreads();
+        torch.setNumThreads(1);
+        const globalThreads = torch.getNumThreads();
+        torch.setNumThreads(0);
+        const model = torch.jit._loadForMobileSync(grayscaleModel);
+        const modelDefault = model.getNumThreads();
+        model.setNumThreads(2);
+        const output = model.forwardSync(torch.rand([1, 3, 4, 4]));
+        defaultThreads > 0 && globalThreads === 1 &&
+          modelDefault === defaultThreads && model.getNumThreads() === 2 &&
+          output.shape[1] === 1;
+      )";
+  EXPECT_TRUE(eval(threads).getBool());
+
+  std::string autotune =
+      R"(
+        const tuned = torch.jit._loadForMobileSync(grayscaleModel, 'cpu', {}, {
+          warmup: {shapes: [[1, 3, 4, 4]]},
+          threads: {maxThreads: 2},
+        });
+        const fixed = torch.jit._loadForMobileSync(grayscaleModel, 'cpu', {}, {
+          threads: 1,
+        });
+        tuned.getNumThreads() >= 1 && tuned.getNumThreads() <= 2 &&
+          tuned.loadStats.autotuneTime >= 0 && fixed.getNumThreads() === 1 &&
+          fixed.loadStats.autotuneTime === 0 &&
+          typeof tuned.loadStats.autotuneCacheError === 'string' &&
+          fixed.loadStats.autotuneCacheError === undefined;
+      )";
+  // Without a cache directory, the tuned thread count can't be stored.
+  torchlive::filesystem::setCacheDirectory("");
+  EXPECT_TRUE(eval(autotune).getBool());
+
+  // The tuned thread count is stored in the cache directory by default.
+  std::string cacheDirectory = testing::TempDir();
+  std::string cachePath = cacheDirectory + "/torchlive.threads";
+  std::remove(cachePath.c_str());
+  torchlive::filesystem::setCacheDirectory(cacheDirectory);
+  std::string cachedAutotune =
+      R"(
+        const cached = torch.jit._loadForMobileSync(grayscaleModel, 'cpu', {}, {
+          warmup: {shapes: [[1, 3, 4, 4]]},
+          threads: {maxThreads: 2},
+        });
+        cached.loadStats.autotuneCacheError === undefined;
+      )";
+  EXPECT_TRUE(eval(cachedAutotune).getBool());
+  EXPECT_TRUE(std::ifstream(cachePath).good());
+  torchlive::filesystem::setCacheDirectory("");
+  std::remove(cachePath.c_str());
+
+  EXPECT_THROW(eval("torch.setNumThreads(-1)"), facebook::jsi::JSError);
+  EXPECT_THROW(
+      eval("torch.jit._loadForMobileSync(grayscaleModel).setNumThreads(1.5)"),
+      facebook::jsi::JSError);
+  EXPECT_THROW(
+      eval("torch.jit._loadForMobileSync(grayscaleModel, 'cpu', {}, "
+           "{threads: 0})"),
+      facebook::jsi::JSError);
+}
+
+TEST_F(TorchliveRuntimeTest, ModuleOutputModeTest) {
+  setGrayscaleModel();
+  std::string lazy =
+      R"(
+        const model = torch.jit._loadForMobileSync(grayscaleModel);
+        model.setOutputMode('lazy');
+        // Tensor outputs are not containers and are returned as tensors.
+        const output = model.forwardSync(torch.rand([1, 3, 4, 4]));
+        model.setOutputMode('eager');
+        output.shape[1] === 1;
+      )";
+  EXPECT_TRUE(eval(lazy).getBool());
+  std::string raw =
+      R"(
+        const model = torch.jit._loadForMobileSync(grayscaleModel);
+        model.setOutputMode('raw');
+        const output = model.forwardSync(torch.rand([1, 3, 4, 4]));
+        model.setOutputMode('eager');
+        output.toTensor().shape[1] === 1;
+      )";
+  EXPECT_TRUE(eval(raw).getBool());
+  EXPECT_THROW(
+      eval("torch.jit._loadForMobileSync(grayscaleModel)"
+           ".setOutputMode('deferred')"),
+      facebook::jsi::JSError);
+}
+
+TEST_F(TorchliveRuntimeTest, TorchJitWarmupTest) {
+  setGrayscaleModel();
+  std::string warmup =
+      R"(
+        const model = torch.jit._loadForMobileSync(grayscaleModel, 'cpu', {}, {
+          warmup: {shapes: [[1, 3, 4, 4]], iterations: 2},
+        });
+        const coldModel = torch.jit._loadForMobileSync(grayscaleModel);
+        model.loadStats.loadTime >= 0 && model.loadStats.warmupTime >= 0 &&
+          coldModel.loadStats.warmupTime === 0;
+      )";
+  EXPECT_TRUE(eval(warmup).getBool());
+
+  // The model has no warmup.txt extra file.
+  EXPECT_THROW(
+      eval("torch.jit._loadForMobileSync(grayscaleModel, 'cpu', {}, "
+           "{warmup: true})"),
+      facebook::jsi::JSError);
+  EXPECT_THROW(
+      eval("torch.jit._loadForMobileSync(grayscaleModel, 'cpu', {}, "
+           "{warmup: {iterations: 0}})"),
+      facebook::jsi::JSError);
+}
+
+namespace mobile = torchlive::torch::jit::mobile;
+
+TEST(TorchJitModelWarmupTest, ParseWarmupShapesTest) {
+  auto shapes = mobile::parseWarmupShapes("1,3,224,224\n\n 1, 10 \r\n");
+  ASSERT_EQ(shapes.size(), 2u);
+  EXPECT_EQ(shapes[0], std::vector<int64_t>({1, 3, 224, 224}));
+  EXPECT_EQ(shapes[1], std::vector<int64_t>({1, 10}));
+  EXPECT_TRUE(mobile::parseWarmupShapes("").empty());
+  EXPECT_THROW(mobile::parseWarmupShapes("1,-3"), std::invalid_argument);
+  EXPECT_THROW(mobile::parseWarmupShapes("1,,3"), std::invalid_argument);
+}
+
+TEST(TorchJitMethodBatcherTest, BatchTest) {
+  std::shared_ptr<char> data(
+      reinterpret_cast<char*>(grayscale_scriptmodule_ptl), [](char*) {});
+  mobile::ExtraFilesMap extraFiles;
+  auto module = mobile::loadFromBuffer(
+      data, grayscale_scriptmodule_ptl_len, torch_::kCPU, extraFiles);
+  auto pool = std::make_shared<mobile::ModulePool>(module);
+  auto function = &module.get_method("forward").function();
+  mobile::MethodBatcher batcher(
+      pool, function, {3, std::chrono::microseconds(std::chrono::seconds(1))});
+
+  // The batch runs as soon as it is full. Calls with the first dimension 1
+  // and 2 are combined, and the call with a different size runs on its own.
+  std::vector<int64_t> batchDims = {1, 2, 1, 1};
+  std::vector<int64_t> widths = {4, 4, 4, 8};
+  std::vector<std::promise<c10::IValue>> outputs(batchDims.size());
+  for (size_t i = 0; i < batchDims.size(); i++) {
+    auto* output = &outputs[i];
+    batcher.submit(
+        {torch_::rand({batchDims[i], 3, 4, widths[i]})},
+        [output](c10::IValue value, std::exception_ptr error) {
+          if (error != nullptr) {
+            output->set_exception(error);
+          } else {
+            output->set_value(std::move(value));
+          }
+        });
+  }
+  for (size_t i = 0; i < batchDims.size(); i++) {
+    auto output = outputs[i].get_future().get().toTensor();
+    std::vector<int64_t> expectedSizes = {batchDims[i], 1, 4, widths[i]};
+    EXPECT_EQ(output.sizes().vec(), expectedSizes);
+  }
+  auto batchSizes = batcher.batchSizes();
+  ASSERT_EQ(batchSizes.size(), 3u);
+  EXPECT_EQ(batchSizes[0], 1u);
+  EXPECT_EQ(batchSizes[2], 1u);
+}
+
+TEST(TorchJitModulePoolTest, CheckoutTest) {
+  std::shared_ptr<char> data(
+      reinterpret_cast<char*>(grayscale_scriptmodule_ptl), [](char*) {});
+  mobile::ExtraFilesMap extraFiles;
+  auto module = mobile::loadFromBuffer(
+      data, grayscale_scriptmodule_ptl_len, torch_::kCPU, extraFiles);
+  auto pool = std::make_shared<mobile::ModulePool>(module);
+  pool->resize(2);
+  {
+    auto first = pool->checkout();
+    auto second = pool->checkout();
+    // The first replica is the module itself, the second one is a copy that
+    // shares the tensors.
+    EXPECT_EQ(first.module()._ivalue(), module._ivalue());
+    EXPECT_NE(second.module()._ivalue(), module._ivalue());
+
+    // A third call waits until a replica is checked in.
+    std::atomic<bool> done(false);
+    std::thread waiting([&]() {
+      auto third = pool->checkout();
+      done = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(done);
+    EXPECT_EQ(pool->stats().queued, 1u);
+    {
+      auto released = std::move(first);
+    }
+    waiting.join();
+    EXPECT_TRUE(done);
+  }
+  auto stats = pool->stats();
+  ASSERT_EQ(stats.replicas.size(), 2u);
+  EXPECT_EQ(stats.replicas[0].calls + stats.replicas[1].calls, 3u);
+  EXPECT_EQ(stats.queued, 0u);
+}
+
+TEST(TorchJitModulePoolTest, PostTest) {
+  std::shared_ptr<char> data(
+      reinterpret_cast<char*>(grayscale_scriptmodule_ptl), [](char*) {});
+  mobile::ExtraFilesMap extraFiles;
+  auto module = mobile::loadFromBuffer(
+      data, grayscale_scriptmodule_ptl_len, torch_::kCPU, extraFiles);
+  auto pool = std::make_shared<mobile::ModulePool>(module);
+  auto function = &module.get_method("forward").function();
+  pool->resize(1);
+
+  // Tasks posted while the replica is busy wait in the pool, and run in order
+  // on the replica once it is checked in.
+  std::vector<std::promise<std::size_t>> order(3);
+  std::atomic<std::size_t> started(0);
+  {
+    auto busy = pool->checkout();
+    for (auto& promise : order) {
+      auto* result = &promise;
+      pool->post(
+          [pool, function, result, &started]() {
+            auto index = started++;
+            // Runs on the replica of the task instead of waiting for one.
+            pool->run(function, {torch_::rand({1, 3, 4, 4})});
+            result->set_value(index);
+          },
+          torchlive::ThreadPool::Priority::kInteractive);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(started, 0u);
+    EXPECT_EQ(pool->stats().queued, 3u);
+  }
+  for (std::size_t i = 0; i < order.size(); i++) {
+    EXPECT_EQ(order[i].get_future().get(), i);
+  }
+  EXPECT_EQ(pool->stats().replicas[0].calls, 4u);
+  EXPECT_EQ(pool->stats().queued, 0u);
+}
+
+TEST(TorchJitCachingAllocatorTest, CacheTest) {
+  mobile::CachingAllocator allocator;
+  auto run = [&allocator]() {
+    mobile::CachingAllocator::Guard guard(allocator);
+    // Intermediate tensors freed within the guard are cached.
+    torch_::ones({64, 64}).add(1);
+  };
+  run();
+  auto first = allocator.stats();
+  run();
+  auto second = allocator.stats();
+  // Allocations are routed to the allocator only in builds with the mobile
+  // CPU allocator.
+  if (first.allocations > 0) {
+    EXPECT_GT(first.cachedBytes, 0u);
+    EXPECT_GT(second.hits, first.hits);
+    EXPECT_EQ(second.cachedBytes, first.cachedBytes);
+  }
+  allocator.trim();
+  auto trimmed = allocator.stats();
+  EXPECT_EQ(trimmed.cachedBytes, 0u);
+  EXPECT_EQ(trimmed.allocations, second.allocations);
+}
+
+TEST(TorchJitIntraOpThreadsTest, CallGateTest) {
+  {
+    mobile::IntraOpThreadsCall first(1);
+    EXPECT_EQ(at::get_num_threads(), 1);
+    // Calls that start while another call runs don't resize the threads.
+    std::thread([]() {
+      mobile::IntraOpThreadsCall second(2);
+      EXPECT_EQ(at::get_num_threads(), 1);
+    }).join();
+    mobile::IntraOpThreadsCall nested(2);
+    EXPECT_EQ(at::get_num_threads(), 1);
+  }
+  {
+    mobile::IntraOpThreadsCall call(2);
+    EXPECT_EQ(at::get_num_threads(), 2);
+  }
+
+  // An exclusive hold waits for the running calls.
+  std::atomic<bool> acquired(false);
+  std::thread exclusive;
+  {
+    mobile::IntraOpThreadsCall call(1);
+    exclusive = std::thread([&acquired]() {
+      mobile::ExclusiveIntraOpThreads hold;
+      acquired = true;
+      hold.resize(3);
+      // Calls nested in the hold run at its thread count.
+      mobile::IntraOpThreadsCall nested(1);
+      EXPECT_EQ(at::get_num_threads(), 3);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(acquired);
+  }
+  exclusive.join();
+  EXPECT_TRUE(acquired);
+  mobile::IntraOpThreadsCall restore(0);
+}
+
+TEST(TorchJitIntraOpThreadsTest, TunedThreadsTest) {
+  const char model[] = "model data";
+  auto fingerprint = mobile::modelFingerprint(model, sizeof(model));
+  EXPECT_EQ(fingerprint, mobile::modelFingerprint(model, sizeof(model)));
+  EXPECT_NE(fingerprint, mobile::modelFingerprint(model, sizeof(model) - 1));
+  auto key = mobile::threadTuningKey(fingerprint);
+  EXPECT_EQ(key.find(' '), std::string::npos);
+
+  std::string path = std::string(testing::TempDir()) + "torchlive.threads";
+  std::remove(path.c_str());
+  EXPECT_FALSE(mobile::readTunedThreads(path, key).has_value());
+  mobile::writeTunedThreads(path, "other", 4);
+  mobile::writeTunedThreads(path, key, 2);
+  mobile::writeTunedThreads(path, key, 3);
+  EXPECT_EQ(mobile::readTunedThreads(path, key), c10::optional<size_t>(3));
+  EXPECT_EQ(mobile::readTunedThreads(path, "other"), c10::optional<size_t>(4));
+  std::remove(path.c_str());
+}
+
+TEST(TorchJitModelRegistryTest, ConcurrentLoadTest) {
+  std::string path = std::string(testing::TempDir()) + "torchlive_model.ptl";
+  {
+    std::ofstream out(path, std::ios::binary);
+    out.write(
+        reinterpret_cast<char*>(grayscale_scriptmodule_ptl),
+        grayscale_scriptmodule_ptl_len);
+  }
+
+  // Concurrent loads of the same model share one load.
+  auto& registry = mobile::ModelRegistry::instance();
+  std::vector<std::shared_ptr<const mobile::ModelRegistry::Model>> models(4);
+  std::vector<std::thread> threads;
+  for (auto& model : models) {
+    threads.emplace_back([&registry, &path, &model]() {
+      mobile::ModelRegistry::ExtraFilesMap extraFiles;
+      model = registry.load(path, torch_::kCPU, extraFiles);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  std::remove(path.c_str());
+  for (const auto& model : models) {
+    EXPECT_EQ(model, models[0]);
+  }
+  std::size_t resident = 0;
+  for (const auto& model : registry.stats()) {
+    resident += model.path == path ? 1 : 0;
+  }
+  EXPECT_EQ(resident, 1u);
+  for (auto& model : models) {
+    registry.release(std::move(model));
+  }
+}
+
+TEST(TorchJitOpProfilerTest, ProfileTest) {
+  std::shared_ptr<char> data(
+      reinterpret_cast<char*>(grayscale_scriptmodule_ptl), [](char*) {});
+  mobile::ExtraFilesMap extraFiles;
+  auto module = mobile::loadFromBuffer(
+      data, grayscale_scriptmodule_ptl_len, torch_::kCPU, extraFiles);
+
+  std::vector<mobile::OpEvent> events;
+  {
+    mobile::OpProfiler profiler;
+    module.forward({torch_::rand({1, 3, 4, 4})});
+    events = profiler.stop();
+    // Operator calls after stop are not recorded.
+    torch_::rand({2, 2});
+  }
+  ASSERT_FALSE(events.empty());
+  bool hasShapes = false;
+  for (size_t i = 0; i < events.size(); i++) {
+    EXPECT_FALSE(events[i].name.empty());
+    EXPECT_GE(events[i].duration.count(), 0);
+    EXPECT_GE(events[i].depth, 0);
+    if (i > 0) {
+      EXPECT_GE(events[i].start, events[i - 1].start);
+    }
+    for (const auto& shape : events[i].shapes) {
+      hasShapes = hasShapes || shape == std::vector<int64_t>({1, 3, 4, 4});
+    }
+  }
+  EXPECT_TRUE(hasShapes);
+
+  auto trace = mobile::OpProfiler::toChromeTrace(events);
+  EXPECT_EQ(trace.rfind("{\"traceEvents\":[", 0), 0u);
+  EXPECT_NE(trace.find("\"ph\":\"X\""), std::string::npos);
+
+  std::string path = std::string(testing::TempDir()) + "torchlive_trace.json";
+  torchlive::filesystem::writeFile(path, trace);
+  std::ifstream in(path, std::ios::binary);
+  std::stringstream written;
+  written << in.rdbuf();
+  std::remove(path.c_str());
+  EXPECT_EQ(written.str(), trace);
+  EXPECT_THROW(
+      torchlive::filesystem::writeFile(path + "/missing/trace.json", trace),
+      std::runtime_error);
+}
+
+TEST(TorchJitModelLoaderTest, MapFileTest) {
+  std::string path = std::string(testing::TempDir()) + "torchlive_map_file";
+  // Flatbuffer files carry the "PTMF" identifier after the root offset.
+  const char content[] = "\x10\x00\x00\x00PTMF model data";
+  {
+    std::ofstream out(path, std::ios::binary);
+    out.write(content, sizeof(content) - 1);
+  }
+
+  std::size_t size = 0;
+  auto data = mobile::mapFile(path, &size);
+  std::remove(path.c_str());
+  ASSERT_EQ(size, sizeof(content) - 1);
+  EXPECT_TRUE(mobile::isFlatbufferModel(data.get(), size));
+  EXPECT_FALSE(mobile::isFlatbufferModel("PK\x03\x04", 4));
+
+  mobile::BufferReadAdapter adapter(data, size);
+  char buf[4];
+  EXPECT_EQ(adapter.size(), size);
+  EXPECT_EQ(adapter.read(4, buf, sizeof(buf)), sizeof(buf));
+  EXPECT_EQ(std::memcmp(buf, "PTMF", sizeof(buf)), 0);
+  // Reads are clamped to the end of the data.
+  EXPECT_EQ(adapter.read(size - 2, buf, sizeof(buf)), 2u);
+
+  EXPECT_THROW(mobile::mapFile(path, &size), std::runtime_error);
+}
+
+// Compares time to first forward and peak memory of loading a model with and
+// without memory mapping. Run each mode in a separate process, because the peak
+// RSS never decreases, e.g.:
+//
+//   TORCHLIVE_BENCHMARK_MODEL=model.ptl TORCHLIVE_BENCHMARK_SHAPE=1,3,224,224 \
+//   TORCHLIVE_BENCHMARK_MMAP=1 ./torchlive_tests \
+//     --gtest_also_run_disabled_tests \
+//     --gtest_filter=TorchJitModelLoaderTest.DISABLED_LoadBenchmark
+TEST(TorchJitModelLoaderTest, DISABLED_LoadBenchmark) {
+  const char* path = std::getenv("TORCHLIVE_BENCHMARK_MODEL");
+  if (path == nullptr) {
+    GTEST_SKIP() << "TORCHLIVE_BENCHMARK_MODEL is not set";
+  }
+  std::vector<int64_t> shape = {1, 3, 224, 224};
+  const char* shapeEnv = std::getenv("TORCHLIVE_BENCHMARK_SHAPE");
+  if (shapeEnv != nullptr) {
+    shape.clear();
+    std::stringstream ss(shapeEnv);
+    std::string dim;
+    while (std::getline(ss, dim, ',')) {
+      shape.push_back(std::stoll(dim));
+    }
+  }
+  const char* mmapEnv = std::getenv("TORCHLIVE_BENCHMARK_MMAP");
+  bool mmap = mmapEnv != nullptr && std::string(mmapEnv) == "1";
+
+  using Clock = std::chrono::steady_clock;
+  auto start = Clock::now();
+  mobile::ExtraFilesMap extraFiles;
+  auto module = [&]() {
+    if (mmap) {
+      std::size_t size = 0;
+      auto data = mobile::mapFile(path, &size);
+      return mobile::loadFromBuffer(
+          std::move(data), size, c10::nullopt, extraFiles);
+    }
+    return torch_::jit::_load_for_mobile(path, c10::nullopt, extraFiles);
+  }();
+  auto loaded = Clock::now();
+  {
+    c10::InferenceMode guard;
+    module.forward({torch_::rand(shape)});
+  }
+  auto forwarded = Clock::now();
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  using std::chrono::duration_cast;
+  using std::chrono::milliseconds;
+  std::cout << "mmap: " << mmap << ", load: "
+            << duration_cast<milliseconds>(loaded - start).count()
+            << " ms, time to first forward: "
+            << duration_cast<milliseconds>(forwarded - start).count()
+            << " ms, peak RSS: " << usage.ru_maxrss << std::endl;
+}
+
 } // namespace
@@ -10,7 +10,10 @@
 #include <fmt/format.h>
 #include <gtest/gtest.h>
 #include <torchlive/Promise.h>
+#include <torchlive/common/CompletionQueue.h>
 #include <torchlive/torchlive.h>
+#include <chrono>
+#include <iostream>
 #include <memory>
 #include <string>
 
@@ -68,4 +71,155 @@ TEST_F(TorchlivePromiseTest, PromiseRejectTest) {
   EXPECT_EQ(eval("result").getString(*rt).utf8(*rt), "try, try again");
 }
 
+TEST_F(TorchlivePromiseTest, PromiseSetupThrowsTest) {
+  auto pValue = torchlive::createPromiseAsJSIValue(
+      *rt, [](jsi::Runtime& rt, std::shared_ptr<torchlive::Promise> p) {
+        throw jsi::JSError(rt, "setup failed");
+      });
+  rt->global().setProperty(*rt, "p", pValue);
+  eval("p.catch(err => { result = err.message; })");
+  EXPECT_EQ(eval("result").getString(*rt).utf8(*rt), "setup failed");
+}
+
+TEST_F(TorchlivePromiseTest, DeferredTest) {
+  auto first = torchlive::createDeferred(*rt);
+  auto second = torchlive::createDeferred(*rt);
+  rt->global().setProperty(*rt, "p1", first.promise);
+  rt->global().setProperty(*rt, "p2", second.promise);
+  eval("results = []; p1.then(val => results.push(val));");
+  eval("p2.catch(err => results.push(err.message));");
+  second.resolver->reject("rejected");
+  first.resolver->resolve(jsi::Value(1));
+  EXPECT_EQ(eval("results.join()").getString(*rt).utf8(*rt), "rejected,1");
+}
+
+TEST_F(TorchlivePromiseTest, PromiseCacheHiddenTest) {
+  torchlive::createDeferred(*rt);
+  std::string hidden =
+      R"(
+        const name = '__torchlivePromiseCache__';
+        const cache = globalThis[name];
+        try {
+          globalThis[name] = null;
+          delete globalThis[name];
+        } catch (e) {}
+        !Object.keys(globalThis).includes(name) && globalThis[name] === cache;
+      )";
+  EXPECT_TRUE(eval(hidden).getBool());
+
+  auto deferred = torchlive::createDeferred(*rt);
+  rt->global().setProperty(*rt, "p", deferred.promise);
+  eval("p.then(val => { result = val; })");
+  deferred.resolver->resolve(jsi::Value(42));
+  EXPECT_EQ(eval("result").getNumber(), 42);
+}
+
+// Measures the per-call overhead of creating a Promise. Run with
+// --gtest_also_run_disabled_tests.
+TEST_F(TorchlivePromiseTest, DISABLED_PromiseCreationBenchmark) {
+  constexpr int kIterations = 100000;
+  using Clock = std::chrono::steady_clock;
+
+  // Baseline: look up the Promise constructor and create an executor host
+  // function for each Promise.
+  auto start = Clock::now();
+  for (int i = 0; i < kIterations; i++) {
+    auto promiseConstructor =
+        rt->global().getPropertyAsFunction(*rt, "Promise");
+    auto executor = jsi::Function::createFromHostFunction(
+        *rt,
+        jsi::PropNameID::forAscii(*rt, "fn"),
+        2,
+        [](jsi::Runtime& rt,
+           const jsi::Value& thisValue,
+           const jsi::Value* args,
+           size_t count) {
+          auto p = std::make_shared<torchlive::Promise>(
+              rt,
+              args[0].getObject(rt).getFunction(rt),
+              args[1].getObject(rt).getFunction(rt));
+          p->resolve(jsi::Value(42));
+          return jsi::Value::undefined();
+        });
+    promiseConstructor.callAsConstructor(*rt, executor);
+  }
+  auto baseline = Clock::now() - start;
+
+  start = Clock::now();
+  for (int i = 0; i < kIterations; i++) {
+    torchlive::createPromiseAsJSIValue(
+        *rt, [](jsi::Runtime& rt, std::shared_ptr<torchlive::Promise> p) {
+          p->resolve(jsi::Value(42));
+        });
+  }
+  auto cached = Clock::now() - start;
+
+  using std::chrono::duration_cast;
+  using std::chrono::nanoseconds;
+  auto baselineNs = duration_cast<nanoseconds>(baseline).count() / kIterations;
+  auto cachedNs = duration_cast<nanoseconds>(cached).count() / kIterations;
+  std::cout << "per-call host function: " << baselineNs << " ns/call\n"
+            << "cached executor: " << cachedNs << " ns/call" << std::endl;
+}
+
+class TorchliveExperimentalTest
+    : public torchlive::test::TorchliveBindingsTestBase {
+ public:
+  TorchliveExperimentalTest() : TorchliveBindingsTestBase() {
+    importTorchliveModule("experimental");
+  }
+};
+
+TEST_F(TorchliveExperimentalTest, WithPriorityTest) {
+  EXPECT_EQ(
+      eval("experimental.withPriority('background', () => 42)").getNumber(),
+      42);
+  EXPECT_EQ(
+      eval("experimental.withPriority('interactive', () => 'a' + 'b')")
+          .getString(*rt)
+          .utf8(*rt),
+      "ab");
+  EXPECT_THROW(
+      eval("experimental.withPriority('urgent', () => 42)"), jsi::JSError);
+  EXPECT_THROW(
+      eval("experimental.withPriority('background', () => { throw 42; })"),
+      jsi::JSError);
+}
+
+TEST_F(TorchliveExperimentalTest, ThreadPoolStatsTest) {
+  std::string threadPoolStats =
+      R"(
+        const stats = experimental.threadPoolStats();
+        ['interactive', 'background'].every(lane =>
+          typeof stats[lane].queued === 'number' &&
+            typeof stats[lane].running === 'number' &&
+            typeof stats[lane].completed === 'number');
+      )";
+  EXPECT_TRUE(eval(threadPoolStats).getBool());
+}
+
+TEST(TorchliveInstallTest, SuccessiveRuntimesTest) {
+  // The completion queue of a runtime is released when the runtime is torn
+  // down, so a later runtime at the same address gets its own.
+  for (int i = 0; i < 2; i++) {
+    auto rt = facebook::hermes::makeHermesRuntime();
+    torchlive::install(*rt, [](std::function<void(jsi::Runtime&)>&&) {});
+    std::weak_ptr<torchlive::common::CompletionQueue> completionQueue =
+        torchlive::getCompletionQueue(*rt);
+
+    // Installing the bindings again replaces the completion queue, which
+    // stays after the replaced one is collected.
+    torchlive::install(*rt, [](std::function<void(jsi::Runtime&)>&&) {});
+    std::weak_ptr<torchlive::common::CompletionQueue> reinstalled =
+        torchlive::getCompletionQueue(*rt);
+    rt->instrumentation().collectGarbage("test");
+    EXPECT_NE(torchlive::findCompletionQueue(*rt), nullptr);
+    EXPECT_EQ(torchlive::findCompletionQueue(*rt), reinstalled.lock());
+
+    rt.reset();
+    EXPECT_TRUE(completionQueue.expired());
+    EXPECT_TRUE(reinstalled.expired());
+  }
+}
+
 } // namespace
@@ -11,6 +11,7 @@
 #import <ReactCommon/RuntimeExecutor.h>
 #import <jsi/jsi.h>
 #import <sys/utsname.h>
+#import <cxx/src/torchlive/filesystem/FilesystemNamespace.h>
 #import <cxx/src/torchlive/torchlive.h>
 
 #import "PyTorchCoreJSI.h"
@@ -48,6 +49,11 @@ RCT_EXPORT_MODULE()
                 }];
             };
 
+        NSString *cacheDirectory =
+            NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject;
+        if (cacheDirectory != nil) {
+            torchlive::filesystem::setCacheDirectory([cacheDirectory UTF8String]);
+        }
         torchlive::install(*(facebook::jsi::Runtime *)cxxBridge.runtime, runtimeExecutor);
     }
 }
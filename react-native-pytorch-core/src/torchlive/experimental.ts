@@ -9,6 +9,33 @@
 
 import type {Audio} from '../audio/AudioModule';
 
+export type Priority = 'interactive' | 'background';
+
+export type CompletionQueueStats = {
+  callbacks: number;
+  drains: number;
+  coalesced: number;
+};
+
+/**
+ * The subset of `AbortSignal` used by [[Experimental.withSignal]].
+ */
+export type AbortSignalLike = {
+  aborted: boolean;
+  addEventListener(type: 'abort', listener: () => void): void;
+};
+
+export type ThreadPoolLaneStats = {
+  queued: number;
+  running: number;
+  completed: number;
+};
+
+export type ThreadPoolStats = {
+  interactive: ThreadPoolLaneStats;
+  background: ThreadPoolLaneStats;
+};
+
 /**
  * :::caution
  *
@@ -28,6 +55,64 @@ interface Experimental {
    * @returns A promise resolving into an [[Audio]].
    */
   audioFromBytes(bytes: number[], sampleRate: number): Promise<Audio>;
+  /**
+   * @experimental
+   *
+   * Returns how many results of async functions were delivered to the
+   * JavaScript thread (`callbacks`), in how many JavaScript thread hops
+   * (`drains`), and how many hops were saved by delivering results that were
+   * ready at the same time together (`coalesced`).
+   */
+  completionQueueStats(): CompletionQueueStats;
+  /**
+   * @experimental
+   *
+   * Returns the number of tasks that are queued, running, and completed in
+   * each priority lane of the thread pool that runs async functions like
+   * `module.forward`.
+   */
+  threadPoolStats(): ThreadPoolStats;
+  /**
+   * @experimental
+   *
+   * Calls `func` and schedules the async functions it calls (e.g.,
+   * `module.forward` or `tensor.matmulAsync`) with the given priority.
+   * Interactive work takes precedence over background work, but background
+   * work is never starved. By default, loading a model is background work and
+   * everything else is interactive work.
+   *
+   * ```typescript
+   * const output = await experimental.withPriority('background', () =>
+   *   model.forward(input),
+   * );
+   * ```
+   *
+   * @param priority The priority of the async work scheduled by `func`.
+   * @param func The function to call.
+   * @returns The value returned by `func`.
+   */
+  withPriority<T>(priority: Priority, func: () => T): T;
+  /**
+   * @experimental
+   *
+   * Calls `func` and ties the async functions it calls (e.g.,
+   * `module.forward`) to the given signal. When the signal aborts, work that
+   * hasn't started yet is dropped and its promise rejects with an error named
+   * `AbortError`. Work that already started runs to completion.
+   *
+   * ```typescript
+   * const controller = new AbortController();
+   * const promise = experimental.withSignal(controller.signal, () =>
+   *   model.forward(input),
+   * );
+   * controller.abort();
+   * ```
+   *
+   * @param signal The signal to cancel the async work scheduled by `func`.
+   * @param func The function to call.
+   * @returns The value returned by `func`.
+   */
+  withSignal<T>(signal: AbortSignalLike, func: () => T): T;
 }
 
 type Torchlive = {
@@ -7,6 +7,8 @@
  * @format
  */
 
+import type {Blob} from './media';
+
 // Allows tensor data with arbitrary dimensions
 type Item = ItemArray;
 interface ItemArray extends Array<Item | number> {}
@@ -49,10 +51,22 @@ export type IValue =
   | boolean
   | Tensor
   | Dict
+  | NativeIValue
   | IValue[];
 
 export type Dict = {[key: string]: IValue};
 
+/**
+ * A module output that is kept as native value, see the `raw` output mode of
+ * [[Module.setOutputMode]].
+ */
+export interface NativeIValue {
+  toGenericDict(): Dict;
+  toList(): NativeIValue[];
+  toTensor(): Tensor;
+  toTuple(): NativeIValue[];
+}
+
 export interface Module {
   /**
    * Module forward function.
@@ -72,39 +86,295 @@ export interface Module {
    * the [[IValue]] union types.
    */
   forwardSync<In extends IValue[], Out extends IValue>(...inputs: [...In]): Out;
+  /**
+   * Enables or disables latest-wins mode for a module method. In latest-wins
+   * mode, the calls of the method run one at a time. While a call runs, the
+   * newest call waits and starts once the running call settles its promise. A
+   * waiting call that is replaced by a newer call doesn't run, and its promise
+   * rejects with an error named `AbortError`. This keeps latency bounded when
+   * inputs (e.g., camera frames) arrive faster than the model runs.
+   *
+   * @param methodName The name of the method, e.g., `forward`.
+   * @param enabled Whether latest-wins mode is enabled.
+   */
+  setLatestWins(methodName: string, enabled: boolean): void;
+  /**
+   * Sets the number of replicas of the module that method calls run on. The
+   * replicas share the weights of the module, but each replica runs one call
+   * at a time and keeps its own module attributes. Calls wait in order while
+   * all replicas are busy, without occupying a worker thread. With 0 replicas
+   * (the default), calls run on the module without a limit on concurrent
+   * calls.
+   *
+   * The replicas share the intra-op threads of the process, so the thread
+   * count set with [[setNumThreads]] only applies to calls that start while
+   * no other call runs, see [[setNumThreads]].
+   *
+   * @param replicas The number of replicas.
+   */
+  setReplicas(replicas: number): void;
+  /**
+   * Returns the number of calls and the utilization of each replica, see
+   * [[setReplicas]].
+   */
+  getReplicaStats(): ModuleReplicaStats;
+  /**
+   * Enables or disables dynamic batching for a module method. Calls whose
+   * arguments are all tensors with the same dtype and the same sizes except
+   * for the first dimension are concatenated along the first dimension and
+   * run as one call. The outputs are split along the first dimension and
+   * passed to the individual calls, so every tensor in the output must have
+   * the batch size as first dimension.
+   *
+   * @param methodName The name of the method, e.g., `forward`.
+   * @param options The batching options, or `null` to disable batching.
+   * @param options.maxBatchSize The maximum number of calls in a batch,
+   * clamped to 256. Default: 8.
+   * @param options.maxDelay The maximum time in milliseconds a call waits for
+   * other calls to join its batch. Default: 5.
+   */
+  setBatching(
+    methodName: string,
+    options: {maxBatchSize?: number; maxDelay?: number} | null,
+  ): void;
+  /**
+   * Returns the batch size histogram of a method with batching enabled, or
+   * `undefined` if batching is not enabled for the method. The element at
+   * index `i` of `batchSizes` counts the batches of `i + 1` calls.
+   *
+   * @param methodName The name of the method, e.g., `forward`.
+   */
+  getBatchStats(methodName: string): {batchSizes: number[]} | undefined;
+  /**
+   * The time in milliseconds it took to load the module, to tune its thread
+   * count and to warm it up. If the tuned thread count couldn't be stored,
+   * `autotuneCacheError` says why, and the thread count is tuned again on the
+   * next load.
+   */
+  readonly loadStats: {
+    loadTime: number;
+    autotuneTime: number;
+    warmupTime: number;
+    autotuneCacheError?: string;
+  };
+  /**
+   * Sets the number of threads that operators of a method call split their
+   * work across. The threads are shared by all models and async tensor ops,
+   * and can't be resized while any of them runs. A call that starts while no
+   * other call runs resizes the threads to the thread count of its module.
+   * Other calls run at the current thread count. Resizing recreates the
+   * threads, so models whose calls alternate should use the same thread
+   * count, e.g., the default set with `torch.setNumThreads`.
+   *
+   * @param threads The thread count, or `0` to use `torch.getNumThreads()`.
+   */
+  setNumThreads(threads: number): void;
+  /**
+   * Returns the intra-op thread count of method calls.
+   */
+  getNumThreads(): number;
+  /**
+   * Sets how the outputs of method calls are converted to JavaScript values.
+   * In `lazy` mode, dicts, lists and tuples in the output are returned as
+   * objects that convert their elements when they are read, which saves the
+   * conversion of elements that are never read. Lazy lists and tuples are
+   * array-like objects with a `length`, but not arrays, and `toJSON()`
+   * converts them like the `eager` mode, which is the default.
+   *
+   * The `typedArrays` mode converts the whole output like the `eager` mode,
+   * except that lists of floats and ints become `Float64Array`s, which are
+   * created from one buffer instead of element by element.
+   *
+   * The `raw` mode returns the output as a [[NativeIValue]] without
+   * converting it. Native values, as well as lazy outputs, can be passed to
+   * the methods of other modules, which skips the conversion to JavaScript
+   * values and back when the output of one model is the input of another.
+   *
+   * @param mode The output mode, `eager`, `lazy`, `typedArrays` or `raw`.
+   */
+  setOutputMode(mode: 'eager' | 'lazy' | 'typedArrays' | 'raw'): void;
+  /**
+   * Enables or disables the caching allocator of the module, which is
+   * disabled by default. While a method runs, the CPU memory of its
+   * intermediate tensors is allocated from a cache, and is kept in the cache
+   * for the next call when the tensors are freed.
+   *
+   * The cache reuses memory only for allocations of the exact same size, and
+   * keeps all memory until [[Module.trimMemory]] is called. It suits models
+   * that are called repeatedly with inputs of the same sizes. With varying
+   * input sizes, the cache keeps growing.
+   *
+   * @param enabled Whether method calls use the caching allocator.
+   */
+  setCachingAllocator(enabled: boolean): void;
+  /**
+   * Returns the memory cached by the caching allocator to the system.
+   */
+  trimMemory(): void;
+  /**
+   * Returns the statistics of the caching allocator, or `undefined` if it is
+   * disabled.
+   */
+  getAllocatorStats(): ModuleAllocatorStats | undefined;
+  /**
+   * Runs a module method once and records the operator calls it makes.
+   *
+   * @param methodName The name of the method, e.g., `forward`.
+   * @param inputs The arguments of the method.
+   * @param options.tracePath Writes the operator calls as Chrome trace to
+   * this file path, which can be opened in `chrome://tracing` or Perfetto.
+   */
+  profile(
+    methodName: string,
+    inputs: any[],
+    options?: {tracePath?: string},
+  ): Promise<{output: any; events: ModuleOpEvent[]}>;
 }
 
+export type ModuleAllocatorStats = {
+  // Bytes kept in the cache for reuse.
+  cachedBytes: number;
+  allocations: number;
+  // Allocations served from the cache.
+  hits: number;
+  // Fraction of allocations served from the cache.
+  hitRate: number;
+};
+
+export type ModuleOpEvent = {
+  name: string;
+  // Start time in milliseconds relative to the start of the method call.
+  start: number;
+  // Duration in milliseconds.
+  duration: number;
+  // Number of enclosing operator calls.
+  depth: number;
+  // Sizes of the tensor inputs, empty for other inputs.
+  shapes: number[][];
+  // CPU memory allocated and freed by the operator, excluding nested calls.
+  allocatedBytes: number;
+  freedBytes: number;
+};
+
+export type ModuleReplicaStats = {
+  replicas: {
+    calls: number;
+    // Time in milliseconds the replica was running calls.
+    busyTime: number;
+    // Fraction of time the replica was busy since it was created.
+    utilization: number;
+  }[];
+  // Number of calls waiting for a free replica.
+  queued: number;
+};
+
+export type ModelBytes = Blob | ArrayBuffer | ArrayBufferView;
+
+export type LoadForMobileOptions = {
+  mmap?: boolean;
+  warmup?:
+    | boolean
+    | {
+        // Sizes of the float tensor inputs of the forward method. Defaults to
+        // the shapes in the `warmup.txt` extra file of the model, one input
+        // per line with comma-separated sizes.
+        shapes?: number[][];
+        iterations?: number;
+      };
+  threads?:
+    | number
+    | {
+        // The highest thread count to try. Defaults to the number of cores.
+        maxThreads?: number;
+        // The file that stores tuned thread counts by model hash and device.
+        // Defaults to `torchlive.threads` in the cache directory of the app.
+        cachePath?: string;
+      };
+};
+
 export interface JIT {
   /**
    * Loads a serialized mobile module.
    *
-   * @param filePath Path to serialized mobile module.
+   * @param model Path to serialized mobile module, or the serialized mobile
+   * module as [[Blob]], `ArrayBuffer`, or typed array. Bytes in memory are
+   * read in place and must not be modified while the model is loading.
    * @param device Device on which the model will be loaded.
    * @param extraFiles Load extra files when loading the model.
+   * @param options.mmap Memory-map the model file instead of reading it. The
+   * weights of models in the default (zip) format are still copied into
+   * memory, so the resident memory of the loaded model is about the same.
+   * Loading weights in place from the mapping requires models in the
+   * flatbuffer format and a PyTorch build with the flatbuffer loader, which
+   * the prebuilt PyTorch Mobile libraries don't include. Flatbuffer models
+   * fail to load with those libraries. Default: `false`.
+   * @param options.warmup Run the forward method with random inputs before
+   * the promise resolves, so the first real call doesn't pay for lazy
+   * initialization. Pass `true` to use the shapes in the `warmup.txt` extra
+   * file of the model. The time spent is reported in [[Module.loadStats]].
+   * @param options.threads The intra-op thread count of the model, see
+   * [[Module.setNumThreads]]. Pass an object to time the forward method with
+   * 1 to `maxThreads` threads and use the fastest thread count. The result is
+   * stored in `cachePath`, so later loads of the same model on the device
+   * skip the timing. Autotuning uses the warm-up input shapes, and waits for
+   * running method calls and async tensor ops to finish, which then wait for
+   * autotuning to finish, so the timings don't include other work.
    * @returns Serialized mobile module of the specified type extending [[Module]],
    * which, if not specified, default to be [[Module]]
    */
   _loadForMobile<T extends Module = Module>(
-    filePath: string,
+    model: string | ModelBytes,
     device?: Device,
     extraFiles?: ExtraFilesMap,
+    options?: LoadForMobileOptions,
   ): Promise<T>;
   /**
    * Loads a serialized mobile module synchronously.
    *
-   * @param filePath Path to serialized mobile module.
+   * @param model Path to serialized mobile module, or the serialized mobile
+   * module in memory, see [[_loadForMobile]].
    * @param device Device on which the model will be loaded.
    * @param extraFiles Load extra files when loading the model.
+   * @param options.mmap Memory-map the model file, see [[_loadForMobile]].
    * @returns Serialized mobile module of the specified type extending [[Module]],
    * which, if not specified, default to be [[Module]]
    */
   _loadForMobileSync<T extends Module = Module>(
-    filePath: string,
+    model: string | ModelBytes,
     device?: Device,
     extraFiles?: ExtraFilesMap,
+    options?: LoadForMobileOptions,
   ): T;
+  /**
+   * Returns the models in the model cache, most recently used first.
+   *
+   * Loading the same model file for the same device again returns the cached
+   * model instead of another copy of its weights. Models that are not used by
+   * any module are kept in the cache until the resident size of all models
+   * exceeds the budget (see [[setModelCacheBudget]]).
+   */
+  getModelCacheStats(): ModelCacheStats;
+  /**
+   * Sets the budget for the resident size of all cached models. Unused models
+   * are evicted, least recently used first, to stay within the budget. The
+   * default budget is 256 MiB.
+   *
+   * @param budgetBytes The budget in bytes.
+   */
+  setModelCacheBudget(budgetBytes: number): void;
 }
 
+export type ModelCacheStats = {
+  budgetBytes: number;
+  residentBytes: number;
+  models: {
+    path: string;
+    device: string;
+    residentBytes: number;
+    inUse: boolean;
+  }[];
+};
+
 /**
  * A [[Dtype]] is an object that represents the data type of a [[Tensor]].
  *
@@ -165,6 +435,17 @@ export type MemoryFormat =
 // Adopt the notion of a Scalar
 export type Scalar = number;
 
+/**
+ * A multi-dimensional matrix containing elements of a single data type.
+ *
+ * {@link https://pytorch.org/docs/1.12/tensors.html}
+ *
+ * Async ops, like [[matmulAsync]], run on a worker thread instead of the
+ * JavaScript thread. Their input tensors are not copied, and the op reads them
+ * while it runs, so they must not be modified until the promise settles,
+ * neither in place (e.g., `tensor[0] = 1`) nor through the array returned by
+ * [[data]]. Modifications are not detected and can produce wrong results.
+ */
 export interface Tensor {
   /**
    * Computes the absolute value of each element in input.
@@ -234,6 +515,17 @@ export interface Tensor {
    * {@link https://pytorch.org/docs/1.12/generated/torch.Tensor.contiguous.html}
    */
   contiguous(options?: {memoryFormat: MemoryFormat}): Tensor;
+  /**
+   * Releases the memory of the tensor without waiting for the garbage
+   * collector. The tensor can't be used after it is disposed.
+   *
+   * :::note
+   *
+   * The function only exists in JavaScript.
+   *
+   * :::
+   */
+  dispose(): void;
   /**
    * Returns the tensor data as `TypedArray` buffer.
    *
@@ -251,9 +543,19 @@ export interface Tensor {
    *
    * :::
    *
+   * :::caution
+   *
+   * If supported by the React Native version, the returned `TypedArray`
+   * shares its memory with the tensor. Changing the `TypedArray` then changes
+   * the tensor. Use `{copy: true}` to get an independent copy of the data.
+   *
+   * :::
+   *
+   * @param options.copy If `true`, the tensor data is copied into a new buffer.
+   * Default: `false`.
    * @experimental
    */
-  data(): TypedArray;
+  data(options?: {copy?: boolean}): TypedArray;
   /**
    * Divides each element of the input input by the corresponding element of
    * other.
@@ -313,6 +615,14 @@ export interface Tensor {
    * @param other tensor matrix multiplied this tensor.
    */
   matmul(other: Tensor): Tensor;
+  /**
+   * Async version of [[matmul]].
+   *
+   * See [[Tensor]] for the inputs of async ops.
+   *
+   * @param other tensor matrix multiplied this tensor.
+   */
+  matmulAsync(other: Tensor): Promise<Tensor>;
   /**
    * Multiplies input by other scalar or tensor.
    *
@@ -351,6 +661,14 @@ export interface Tensor {
    * @param dim A dimension along which softmax will be computed.
    */
   softmax(dim: number): Tensor;
+  /**
+   * Async version of [[softmax]].
+   *
+   * See [[Tensor]] for the inputs of async ops.
+   *
+   * @param dim A dimension along which softmax will be computed.
+   */
+  softmaxAsync(dim: number): Promise<Tensor>;
   /**
    * Computes the square-root value of each element in input.
    *
@@ -404,6 +722,18 @@ export interface Tensor {
    * @param options.keepdim Whether the output tensor has `dim` retained or not.
    */
   sum(dim: number | number[], options?: {keepdim?: boolean}): Tensor;
+  /**
+   * Async version of [[sum]].
+   *
+   * See [[Tensor]] for the inputs of async ops.
+   *
+   * @param dim The dimension or dimensions to reduce.
+   * @param options.keepdim Whether the output tensor has `dim` retained or not.
+   */
+  sumAsync(
+    dim?: number | number[],
+    options?: {keepdim?: boolean},
+  ): Promise<Tensor>;
   /**
    * Performs Tensor conversion.
    *
@@ -412,6 +742,14 @@ export interface Tensor {
    * @param options Tensor options.
    */
   to(options: TensorOptions): Tensor;
+  /**
+   * Async version of [[to]].
+   *
+   * See [[Tensor]] for the inputs of async ops.
+   *
+   * @param options Tensor options.
+   */
+  toAsync(options: TensorOptions): Promise<Tensor>;
   /**
    * Returns a list of two Tensors where the first represents the k largest elements of the given input tensor,
    * and the second represents the indices of the k largest elements.
@@ -428,6 +766,18 @@ export interface Tensor {
     k: number,
     options?: {dim?: number; largest?: boolean; sorted?: boolean},
   ): [Tensor, Tensor];
+  /**
+   * Async version of [[topk]].
+   *
+   * See [[Tensor]] for the inputs of async ops.
+   *
+   * @param k The k in "top-k"
+   * @param options topk Options as keywords argument in pytorch
+   */
+  topkAsync(
+    k: number,
+    options?: {dim?: number; largest?: boolean; sorted?: boolean},
+  ): Promise<[Tensor, Tensor]>;
   /**
    * Returns a new tensor with a dimension of size one inserted at the
    * specified position.
@@ -451,6 +801,15 @@ export interface Tensor {
   [index: number]: Tensor;
 }
 
+export type TensorStats = {
+  // Tensors created since the app started.
+  allocated: number;
+  // Tensors disposed or garbage collected.
+  freed: number;
+  // Tensors that are not freed yet.
+  live: number;
+};
+
 export interface Torch {
   /**
    * Returns a 1-D tensor of size `(end - 0) / 1` with values from the interval
@@ -531,6 +890,11 @@ export interface Torch {
    *
    * :::
    *
+   * The tensor shares its memory with the blob and keeps the blob data alive.
+   * Create a copy (e.g., with `tensor.add(0)`) before modifying the tensor
+   * in-place to keep the blob data unchanged. An error is thrown if the
+   * sizes and dtype require more bytes than the blob holds.
+   *
    * @param blob The blob holding the data.
    * @param sizes Should specify the shape of the tensor, strides the stride
    * @param options Tensor options
@@ -548,6 +912,36 @@ export interface Torch {
    * @param options Object to customizing dtype, etc. default to be {dtype: torch.float32}
    */
   full(size: number[], fillValue: number, options?: TensorOptions): Tensor;
+  /**
+   * Returns the intra-op thread count of models without a thread count of
+   * their own.
+   *
+   * {@link https://pytorch.org/docs/1.12/generated/torch.get_num_threads.html}
+   */
+  getNumThreads(): number;
+  /**
+   * Returns the number of tensors created and freed so far, e.g., to check
+   * that a loop doesn't leak tensors.
+   *
+   * :::note
+   *
+   * The function only exists in JavaScript.
+   *
+   * :::
+   */
+  getTensorStats(): TensorStats;
+  /**
+   * Keeps the tensor when the [[Torch.scope]] it was created in ends.
+   *
+   * :::note
+   *
+   * The function only exists in JavaScript.
+   *
+   * :::
+   *
+   * @param tensor The tensor to keep.
+   */
+  keep(tensor: Tensor): Tensor;
   /**
    * Creates a one-dimensional tensor of size steps whose values are evenly spaced from `start` to `end`,
    * inclusive.
@@ -640,6 +1034,38 @@ export interface Torch {
    * @param options Object to customizing dtype, etc. default to be {dtype: torch.int64}.
    */
   randperm(n: number, options?: TensorOptions): Tensor;
+  /**
+   * Calls the function and disposes the tensors it created when it returns or
+   * throws, except for the tensors that it returns, also in arrays or
+   * objects, and the tensors passed to [[Torch.keep]]. Returned tensors belong
+   * to the enclosing scope, if any. The function must be synchronous, since
+   * tensors created after it returns aren't disposed by the scope.
+   *
+   * ```typescript
+   * const probabilities = torch.scope(() =>
+   *   model.forwardSync(image.div(255)).softmax(-1),
+   * );
+   * ```
+   *
+   * :::note
+   *
+   * The function only exists in JavaScript.
+   *
+   * :::
+   *
+   * @param fn The function to call.
+   */
+  scope<T>(fn: () => T): T;
+  /**
+   * Sets the intra-op thread count of models without a thread count of their
+   * own, see [[Module.setNumThreads]]. The threads are resized by the next
+   * method call that starts while no other call runs.
+   *
+   * {@link https://pytorch.org/docs/1.12/generated/torch.set_num_threads.html}
+   *
+   * @param threads The thread count, or `0` to restore the PyTorch default.
+   */
+  setNumThreads(threads: number): void;
   /**
    * Constructs a tensor with no autograd history.
    *
@@ -647,6 +1073,20 @@ export interface Torch {
    * @param options Tensor options.
    */
   tensor(data: Scalar | ItemArray, options?: TensorOptions): Tensor;
+  /**
+   * Constructs a tensor from a `TypedArray` or `ArrayBuffer` by copying its
+   * data in bulk. The tensor dtype matches the `TypedArray` type (`uint8` for
+   * an `ArrayBuffer`), unless specified with `options.dtype`.
+   *
+   * @param data Tensor data as `TypedArray` or `ArrayBuffer`.
+   * @param options Tensor options.
+   * @param options.shape The shape of the tensor. Default: the one-dimensional
+   * length of the data.
+   */
+  tensor(
+    data: TypedArray | ArrayBuffer,
+    options?: TensorOptions & {shape?: number[]},
+  ): Tensor;
   /**
    * Returns a tensor filled with the scalar value 0, with the shape defined
    * by the argument `size`.